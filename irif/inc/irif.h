@@ -307,6 +307,14 @@ extern __attribute__((pure)) float4 __llvm_amdgcn_image_gather4_lz_2d_v4f32_f32_
 extern __attribute__((pure)) float4 __llvm_amdgcn_image_gather4_lz_2d_v4f32_f32_g(float x, float y, uint8 t, uint4 s);
 extern __attribute__((pure)) float4 __llvm_amdgcn_image_gather4_lz_2d_v4f32_f32_b(float x, float y, uint8 t, uint4 s);
 extern __attribute__((pure)) float4 __llvm_amdgcn_image_gather4_lz_2d_v4f32_f32_a(float x, float y, uint8 t, uint4 s);
+extern __attribute__((pure)) float4 __llvm_amdgcn_image_gather4_lz_2darray_v4f32_f32_r(float x, float y, float slice, uint8 t, uint4 s);
+extern __attribute__((pure)) float4 __llvm_amdgcn_image_gather4_lz_2darray_v4f32_f32_g(float x, float y, float slice, uint8 t, uint4 s);
+extern __attribute__((pure)) float4 __llvm_amdgcn_image_gather4_lz_2darray_v4f32_f32_b(float x, float y, float slice, uint8 t, uint4 s);
+extern __attribute__((pure)) float4 __llvm_amdgcn_image_gather4_lz_2darray_v4f32_f32_a(float x, float y, float slice, uint8 t, uint4 s);
+extern __attribute__((pure)) float4 __llvm_amdgcn_image_gather4_lz_cube_v4f32_f32_r(float x, float y, float face, uint8 t, uint4 s);
+extern __attribute__((pure)) float4 __llvm_amdgcn_image_gather4_lz_cube_v4f32_f32_g(float x, float y, float face, uint8 t, uint4 s);
+extern __attribute__((pure)) float4 __llvm_amdgcn_image_gather4_lz_cube_v4f32_f32_b(float x, float y, float face, uint8 t, uint4 s);
+extern __attribute__((pure)) float4 __llvm_amdgcn_image_gather4_lz_cube_v4f32_f32_a(float x, float y, float face, uint8 t, uint4 s);
 
 
 #pragma OPENCL EXTENSION cl_khr_fp16 : disable
@@ -210,8 +210,89 @@ extern int OCKL_MANGLE_T(wfscan_xor,i32)(int x, bool inclusive);
 extern long OCKL_MANGLE_T(wfscan_xor,i64)(long x, bool inclusive);
 extern uint OCKL_MANGLE_T(wfscan_xor,u32)(uint x, bool inclusive);
 extern ulong OCKL_MANGLE_T(wfscan_xor,u64)(ulong x, bool inclusive);
+extern half OCKL_MANGLE_T(wfsegred_add,f16)(half x, ulong h);
+extern float OCKL_MANGLE_T(wfsegred_add,f32)(float x, ulong h);
+extern double OCKL_MANGLE_T(wfsegred_add,f64)(double x, ulong h);
+extern int OCKL_MANGLE_T(wfsegred_add,i32)(int x, ulong h);
+extern long OCKL_MANGLE_T(wfsegred_add,i64)(long x, ulong h);
+extern uint OCKL_MANGLE_T(wfsegred_add,u32)(uint x, ulong h);
+extern ulong OCKL_MANGLE_T(wfsegred_add,u64)(ulong x, ulong h);
+extern int OCKL_MANGLE_T(wfsegred_and,i32)(int x, ulong h);
+extern long OCKL_MANGLE_T(wfsegred_and,i64)(long x, ulong h);
+extern uint OCKL_MANGLE_T(wfsegred_and,u32)(uint x, ulong h);
+extern ulong OCKL_MANGLE_T(wfsegred_and,u64)(ulong x, ulong h);
+extern half OCKL_MANGLE_T(wfsegred_max,f16)(half x, ulong h);
+extern float OCKL_MANGLE_T(wfsegred_max,f32)(float x, ulong h);
+extern double OCKL_MANGLE_T(wfsegred_max,f64)(double x, ulong h);
+extern int OCKL_MANGLE_T(wfsegred_max,i32)(int x, ulong h);
+extern long OCKL_MANGLE_T(wfsegred_max,i64)(long x, ulong h);
+extern uint OCKL_MANGLE_T(wfsegred_max,u32)(uint x, ulong h);
+extern ulong OCKL_MANGLE_T(wfsegred_max,u64)(ulong x, ulong h);
+extern half OCKL_MANGLE_T(wfsegred_min,f16)(half x, ulong h);
+extern float OCKL_MANGLE_T(wfsegred_min,f32)(float x, ulong h);
+extern double OCKL_MANGLE_T(wfsegred_min,f64)(double x, ulong h);
+extern int OCKL_MANGLE_T(wfsegred_min,i32)(int x, ulong h);
+extern long OCKL_MANGLE_T(wfsegred_min,i64)(long x, ulong h);
+extern uint OCKL_MANGLE_T(wfsegred_min,u32)(uint x, ulong h);
+extern ulong OCKL_MANGLE_T(wfsegred_min,u64)(ulong x, ulong h);
+extern int OCKL_MANGLE_T(wfsegred_or,i32)(int x, ulong h);
+extern long OCKL_MANGLE_T(wfsegred_or,i64)(long x, ulong h);
+extern uint OCKL_MANGLE_T(wfsegred_or,u32)(uint x, ulong h);
+extern ulong OCKL_MANGLE_T(wfsegred_or,u64)(ulong x, ulong h);
+extern int OCKL_MANGLE_T(wfsegred_xor,i32)(int x, ulong h);
+extern long OCKL_MANGLE_T(wfsegred_xor,i64)(long x, ulong h);
+extern uint OCKL_MANGLE_T(wfsegred_xor,u32)(uint x, ulong h);
+extern ulong OCKL_MANGLE_T(wfsegred_xor,u64)(ulong x, ulong h);
+extern half OCKL_MANGLE_T(wfsegscan_add,f16)(half x, bool inclusive, ulong h);
+extern float OCKL_MANGLE_T(wfsegscan_add,f32)(float x, bool inclusive, ulong h);
+extern double OCKL_MANGLE_T(wfsegscan_add,f64)(double x, bool inclusive, ulong h);
+extern int OCKL_MANGLE_T(wfsegscan_add,i32)(int x, bool inclusive, ulong h);
+extern long OCKL_MANGLE_T(wfsegscan_add,i64)(long x, bool inclusive, ulong h);
+extern uint OCKL_MANGLE_T(wfsegscan_add,u32)(uint x, bool inclusive, ulong h);
+extern ulong OCKL_MANGLE_T(wfsegscan_add,u64)(ulong x, bool inclusive, ulong h);
+extern int OCKL_MANGLE_T(wfsegscan_and,i32)(int x, bool inclusive, ulong h);
+extern long OCKL_MANGLE_T(wfsegscan_and,i64)(long x, bool inclusive, ulong h);
+extern uint OCKL_MANGLE_T(wfsegscan_and,u32)(uint x, bool inclusive, ulong h);
+extern ulong OCKL_MANGLE_T(wfsegscan_and,u64)(ulong x, bool inclusive, ulong h);
+extern half OCKL_MANGLE_T(wfsegscan_max,f16)(half x, bool inclusive, ulong h);
+extern float OCKL_MANGLE_T(wfsegscan_max,f32)(float x, bool inclusive, ulong h);
+extern double OCKL_MANGLE_T(wfsegscan_max,f64)(double x, bool inclusive, ulong h);
+extern int OCKL_MANGLE_T(wfsegscan_max,i32)(int x, bool inclusive, ulong h);
+extern long OCKL_MANGLE_T(wfsegscan_max,i64)(long x, bool inclusive, ulong h);
+extern uint OCKL_MANGLE_T(wfsegscan_max,u32)(uint x, bool inclusive, ulong h);
+extern ulong OCKL_MANGLE_T(wfsegscan_max,u64)(ulong x, bool inclusive, ulong h);
+extern half OCKL_MANGLE_T(wfsegscan_min,f16)(half x, bool inclusive, ulong h);
+extern float OCKL_MANGLE_T(wfsegscan_min,f32)(float x, bool inclusive, ulong h);
+extern double OCKL_MANGLE_T(wfsegscan_min,f64)(double x, bool inclusive, ulong h);
+extern int OCKL_MANGLE_T(wfsegscan_min,i32)(int x, bool inclusive, ulong h);
+extern long OCKL_MANGLE_T(wfsegscan_min,i64)(long x, bool inclusive, ulong h);
+extern uint OCKL_MANGLE_T(wfsegscan_min,u32)(uint x, bool inclusive, ulong h);
+extern ulong OCKL_MANGLE_T(wfsegscan_min,u64)(ulong x, bool inclusive, ulong h);
+extern int OCKL_MANGLE_T(wfsegscan_or,i32)(int x, bool inclusive, ulong h);
+extern long OCKL_MANGLE_T(wfsegscan_or,i64)(long x, bool inclusive, ulong h);
+extern uint OCKL_MANGLE_T(wfsegscan_or,u32)(uint x, bool inclusive, ulong h);
+extern ulong OCKL_MANGLE_T(wfsegscan_or,u64)(ulong x, bool inclusive, ulong h);
+extern int OCKL_MANGLE_T(wfsegscan_xor,i32)(int x, bool inclusive, ulong h);
+extern long OCKL_MANGLE_T(wfsegscan_xor,i64)(long x, bool inclusive, ulong h);
+extern uint OCKL_MANGLE_T(wfsegscan_xor,u32)(uint x, bool inclusive, ulong h);
+extern ulong OCKL_MANGLE_T(wfsegscan_xor,u64)(ulong x, bool inclusive, ulong h);
 extern uint OCKL_MANGLE_U32(wfbcast)(uint x, uint i);
 extern ulong OCKL_MANGLE_U64(wfbcast)(ulong x, uint i);
+extern ulong OCKL_MANGLE_U32(wfmatch_any)(uint x);
+extern ulong OCKL_MANGLE_U64(wfmatch_any)(ulong x);
+extern ulong OCKL_MANGLE_U32(wfmatch_all)(uint x);
+extern ulong OCKL_MANGLE_U64(wfmatch_all)(ulong x);
+extern uint OCKL_MANGLE_U32(wfsort)(uint x, bool descending);
+extern float OCKL_MANGLE_F32(wfsort)(float x, bool descending);
+extern uint2 OCKL_MANGLE_T(wfsort_kv,u32)(uint k, uint v, bool descending);
+extern uint OCKL_MANGLE_U32(wftopk)(uint x, uint n);
+extern float OCKL_MANGLE_F32(wftopk)(float x, uint n);
+extern uint OCKL_MANGLE_U32(wfagg_atomic_inc)(__global uint *p);
+extern int OCKL_MANGLE_I32(wfagg_atomic_add)(__global int *p, int x);
+extern uint OCKL_MANGLE_U32(wfagg_atomic_add)(__global uint *p, uint x);
+extern long OCKL_MANGLE_I64(wfagg_atomic_add)(__global long *p, long x);
+extern ulong OCKL_MANGLE_U64(wfagg_atomic_add)(__global ulong *p, ulong x);
+extern float OCKL_MANGLE_F32(wfagg_atomic_add)(__global float *p, float x);
 
 extern bool OCKL_MANGLE_I32(wfany)(int e);
 extern bool OCKL_MANGLE_I32(wfall)(int e);
@@ -252,6 +333,19 @@ extern __attribute__((const)) float OCKL_MANGLE_F32(unpack3)(uint);
 #define SSHARP __constant uint *
 #define TSHARP __constant uint *
 
+// The T# fields the samplers need, decoded once by __ockl_image_info_<dim>
+// so that loops reading one image many times do not repeat the extraction
+typedef struct __ockl_image_info {
+    uint width;
+    uint height;                // 1 for 1D images
+    uint depth;                 // Depth of a 3D image, layers of an array, else 1
+    int channel_data_type;
+    int channel_order;
+    float rwidth;               // Reciprocals of width, height and depth
+    float rheight;
+    float rdepth;
+} __ockl_image_info_t;
+
 extern __attribute__((pure)) float4 OCKL_MANGLE_T(image_load,1D)(TSHARP i, int c);
 extern __attribute__((pure)) float4 OCKL_MANGLE_T(image_load,1Da)(TSHARP i, int2 c);
 extern __attribute__((pure)) float4 OCKL_MANGLE_T(image_load,1Db)(TSHARP i, int c);
@@ -331,6 +425,12 @@ extern __attribute__((pure)) float OCKL_MANGLE_T(image_sample,2Dd)(TSHARP i, SSH
 extern __attribute__((pure)) float4 OCKL_MANGLE_T(image_sample,3D)(TSHARP i, SSHARP s, float4 c);
 extern __attribute__((pure)) float4 OCKL_MANGLE_T(image_sample,CM)(TSHARP i, SSHARP s, float4 c);
 extern __attribute__((pure)) float4 OCKL_MANGLE_T(image_sample,CMa)(TSHARP i, SSHARP s, float4 c);
+
+extern __attribute__((pure)) float4 OCKL_MANGLE_T(image_sample_info,1D)(TSHARP i, SSHARP s, __ockl_image_info_t n, float c);
+extern __attribute__((pure)) float4 OCKL_MANGLE_T(image_sample_info,1Da)(TSHARP i, SSHARP s, __ockl_image_info_t n, float2 c);
+extern __attribute__((pure)) float4 OCKL_MANGLE_T(image_sample_info,2D)(TSHARP i, SSHARP s, __ockl_image_info_t n, float2 c);
+extern __attribute__((pure)) float4 OCKL_MANGLE_T(image_sample_info,2Da)(TSHARP i, SSHARP s, __ockl_image_info_t n, float4 c);
+extern __attribute__((pure)) float4 OCKL_MANGLE_T(image_sample_info,3D)(TSHARP i, SSHARP s, __ockl_image_info_t n, float4 c);
 extern __attribute__((pure)) float4 OCKL_MANGLE_T(image_sample_grad,1D)(TSHARP i, SSHARP s, float c, float dx, float dy);
 extern __attribute__((pure)) float4 OCKL_MANGLE_T(image_sample_grad,1Da)(TSHARP i, SSHARP s, float2 c, float dx, float dy);
 extern __attribute__((pure)) float4 OCKL_MANGLE_T(image_sample_grad,2D)(TSHARP i, SSHARP s, float2 c, float2 dx, float2 dy);
@@ -371,6 +471,14 @@ extern __attribute__((pure)) float4 OCKL_MANGLE_T(image_gather4r,2D)(TSHARP i, S
 extern __attribute__((pure)) float4 OCKL_MANGLE_T(image_gather4g,2D)(TSHARP i, SSHARP s, float2 c);
 extern __attribute__((pure)) float4 OCKL_MANGLE_T(image_gather4b,2D)(TSHARP i, SSHARP s, float2 c);
 extern __attribute__((pure)) float4 OCKL_MANGLE_T(image_gather4a,2D)(TSHARP i, SSHARP s, float2 c);
+extern __attribute__((pure)) float4 OCKL_MANGLE_T(image_gather4r,2Da)(TSHARP i, SSHARP s, float4 c);
+extern __attribute__((pure)) float4 OCKL_MANGLE_T(image_gather4g,2Da)(TSHARP i, SSHARP s, float4 c);
+extern __attribute__((pure)) float4 OCKL_MANGLE_T(image_gather4b,2Da)(TSHARP i, SSHARP s, float4 c);
+extern __attribute__((pure)) float4 OCKL_MANGLE_T(image_gather4a,2Da)(TSHARP i, SSHARP s, float4 c);
+extern __attribute__((pure)) float4 OCKL_MANGLE_T(image_gather4r,CM)(TSHARP i, SSHARP s, float4 c);
+extern __attribute__((pure)) float4 OCKL_MANGLE_T(image_gather4g,CM)(TSHARP i, SSHARP s, float4 c);
+extern __attribute__((pure)) float4 OCKL_MANGLE_T(image_gather4b,CM)(TSHARP i, SSHARP s, float4 c);
+extern __attribute__((pure)) float4 OCKL_MANGLE_T(image_gather4a,CM)(TSHARP i, SSHARP s, float4 c);
 
 extern __attribute__((const)) int OCKL_MANGLE_T(image_array_size,1Da)(TSHARP i);
 extern __attribute__((const)) int OCKL_MANGLE_T(image_array_size,2Da)(TSHARP i);
@@ -409,6 +517,12 @@ extern __attribute__((const)) int OCKL_MANGLE_T(image_height,3D)(TSHARP i);
 extern __attribute__((const)) int OCKL_MANGLE_T(image_height,CM)(TSHARP i);
 extern __attribute__((const)) int OCKL_MANGLE_T(image_height,CMa)(TSHARP i);
 
+extern __attribute__((const)) __ockl_image_info_t OCKL_MANGLE_T(image_info,1D)(TSHARP i);
+extern __attribute__((const)) __ockl_image_info_t OCKL_MANGLE_T(image_info,1Da)(TSHARP i);
+extern __attribute__((const)) __ockl_image_info_t OCKL_MANGLE_T(image_info,2D)(TSHARP i);
+extern __attribute__((const)) __ockl_image_info_t OCKL_MANGLE_T(image_info,2Da)(TSHARP i);
+extern __attribute__((const)) __ockl_image_info_t OCKL_MANGLE_T(image_info,3D)(TSHARP i);
+
 extern __attribute__((const)) int OCKL_MANGLE_T(image_num_mip_levels,1D)(TSHARP i);
 extern __attribute__((const)) int OCKL_MANGLE_T(image_num_mip_levels,1Da)(TSHARP i);
 extern __attribute__((const)) int OCKL_MANGLE_T(image_num_mip_levels,2D)(TSHARP i);
@@ -444,6 +558,16 @@ extern __attribute__((const)) size_t __ockl_get_local_linear_id(void);
 extern __attribute__((const)) int  __ockl_readuplane_i32(int, int);
 extern __attribute__((const)) long  __ockl_readuplane_i64(long, int);
 
+extern __attribute__((convergent)) void __ockl_gws_init(uint nwm1, uint rid);
+extern __attribute__((convergent)) void __ockl_gws_barrier(uint nwm1, uint rid);
+extern __attribute__((convergent)) void __ockl_grid_sync(void);
+extern __attribute__((const)) bool __ockl_multi_grid_is_valid(void);
+extern __attribute__((convergent)) void __ockl_multi_grid_sync(void);
+extern __attribute__((pure)) uint __ockl_multi_grid_num_grids(void);
+extern __attribute__((pure)) uint __ockl_multi_grid_grid_rank(void);
+extern __attribute__((pure)) uint __ockl_multi_grid_size(void);
+extern __attribute__((pure)) uint __ockl_multi_grid_thread_rank(void);
+
 extern __attribute__((const)) bool OCKL_MANGLE_T(is_local,addr)(const void *);
 extern __attribute__((const)) bool OCKL_MANGLE_T(is_private,addr)(const void *);
 extern __attribute__((const)) __global void * OCKL_MANGLE_T(to,global)(void *);
@@ -8,6 +8,8 @@
 #include "irif.h"
 #include "ockl.h"
 
+#include "mgsync.h"
+
 __attribute__((convergent)) void
 __ockl_gws_init(uint nwm1, uint rid)
 {
@@ -59,3 +61,78 @@ __ockl_grid_sync(void)
     __builtin_amdgcn_s_barrier();
 }
 
+// Per-grid multi-grid description found through the hidden multigrid
+// sync kernel argument
+struct mg_info {
+    __global struct mg_sync *mgs;
+    uint grid_id;
+    uint num_grids;
+    ulong prev_sum;
+    ulong all_sum;
+};
+
+static __global struct mg_info *
+get_mg_info(void)
+{
+    __constant size_t *argptr = (__constant size_t *)__builtin_amdgcn_implicitarg_ptr();
+    return (__global struct mg_info *)argptr[6];
+}
+
+static bool
+is_grid_leader(void)
+{
+    return (__builtin_amdgcn_workgroup_id_x() | __builtin_amdgcn_workgroup_id_y() |
+            __builtin_amdgcn_workgroup_id_z() | (uint)__ockl_get_local_linear_id()) == 0;
+}
+
+__attribute__((const)) bool
+__ockl_multi_grid_is_valid(void)
+{
+    return get_mg_info() != (__global struct mg_info *)0;
+}
+
+__attribute__((convergent)) void
+__ockl_multi_grid_sync(void)
+{
+    __llvm_fence_sc_sys();
+    bool wg_leader = __ockl_get_local_linear_id() == 0;
+    uint nwm1 = (uint)__ockl_get_num_groups(0) * (uint)__ockl_get_num_groups(1) * (uint)__ockl_get_num_groups(2) - 1;
+
+    if (wg_leader)
+        __ockl_gws_barrier(nwm1, 0);
+    __builtin_amdgcn_s_barrier();
+
+    if (is_grid_leader()) {
+        __global struct mg_info *mi = get_mg_info();
+        mg_barrier(mi->mgs, mi->num_grids);
+    }
+
+    if (wg_leader)
+        __ockl_gws_barrier(nwm1, 0);
+    __builtin_amdgcn_s_barrier();
+    __llvm_fence_sc_sys();
+}
+
+__attribute__((pure)) uint
+__ockl_multi_grid_num_grids(void)
+{
+    return get_mg_info()->num_grids;
+}
+
+__attribute__((pure)) uint
+__ockl_multi_grid_grid_rank(void)
+{
+    return get_mg_info()->grid_id;
+}
+
+__attribute__((pure)) uint
+__ockl_multi_grid_size(void)
+{
+    return (uint)get_mg_info()->all_sum;
+}
+
+__attribute__((pure)) uint
+__ockl_multi_grid_thread_rank(void)
+{
+    return (uint)get_mg_info()->prev_sum + (uint)__ockl_get_global_linear_id();
+}
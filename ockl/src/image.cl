@@ -60,6 +60,45 @@
     C.z = _m ? C.z : _z; \
 } while (0)
 
+// The same adjustments with the sizes taken from a decoded __ockl_image_info
+#define ADJUST_X_INFO(C,N,S) do { \
+    bool _f = FIELD(S,15,1); \
+    float _p = _f ? 1.0f : (float)N.width; \
+    float _rp = _f ? 1.0f : N.rwidth; \
+    float _x = __builtin_floorf(C * _p) * _rp; \
+    C = FIELD(S,84,1) ? C : _x; \
+} while (0)
+
+#define ADJUST_XY_INFO(C,N,S) do { \
+    bool _f = FIELD(S,15,1); \
+    float _p = _f ? 1.0f : (float)N.width; \
+    float _q = _f ? 1.0f : (float)N.height; \
+    float _rp = _f ? 1.0f : N.rwidth; \
+    float _rq = _f ? 1.0f : N.rheight; \
+    float _x = __builtin_floorf(C.x * _p) * _rp; \
+    float _y = __builtin_floorf(C.y * _q) * _rq; \
+    bool _m = FIELD(S,84,1); \
+    C.x = _m ? C.x : _x; \
+    C.y = _m ? C.y : _y; \
+} while (0)
+
+#define ADJUST_XYZ_INFO(C,N,S) do { \
+    bool _f = FIELD(S,15,1); \
+    float _p = _f ? 1.0f : (float)N.width; \
+    float _q = _f ? 1.0f : (float)N.height; \
+    float _r = _f ? 1.0f : (float)N.depth; \
+    float _rp = _f ? 1.0f : N.rwidth; \
+    float _rq = _f ? 1.0f : N.rheight; \
+    float _rr = _f ? 1.0f : N.rdepth; \
+    float _x = __builtin_floorf(C.x * _p) * _rp; \
+    float _y = __builtin_floorf(C.y * _q) * _rq; \
+    float _z = __builtin_floorf(C.z * _r) * _rr; \
+    bool _m = FIELD(S,84,1); \
+    C.x = _m ? C.x : _x; \
+    C.y = _m ? C.y : _y; \
+    C.z = _m ? C.z : _z; \
+} while (0)
+
 GATTR
 static float fmuladd_f32(float a, float b, float c)
 {
@@ -674,6 +713,43 @@ OCKL_MANGLE_T(image_sample_lod,CMa)(TSHARP i, SSHARP s, float4 c, float l)
     return __llvm_amdgcn_image_sample_l_cube_v4f32_f32(c.x, c.y, c.z, l, LOAD_TSHARP(i), LOAD_SSHARP(s));
 }
 
+RATTR float4
+OCKL_MANGLE_T(image_sample_info,1D)(TSHARP i, SSHARP s, __ockl_image_info_t n, float c)
+{
+    ADJUST_X_INFO(c, n, s);
+    return __llvm_amdgcn_image_sample_lz_1d_v4f32_f32(c, LOAD_TSHARP(i), LOAD_SSHARP(s));
+}
+
+RATTR float4
+OCKL_MANGLE_T(image_sample_info,1Da)(TSHARP i, SSHARP s, __ockl_image_info_t n, float2 c)
+{
+    ADJUST_X_INFO(c.x, n, s);
+    c.y = __builtin_rintf(c.y);
+    return __llvm_amdgcn_image_sample_lz_1darray_v4f32_f32(c.x, c.y, LOAD_TSHARP(i), LOAD_SSHARP(s));
+}
+
+RATTR float4
+OCKL_MANGLE_T(image_sample_info,2D)(TSHARP i, SSHARP s, __ockl_image_info_t n, float2 c)
+{
+    ADJUST_XY_INFO(c, n, s);
+    return __llvm_amdgcn_image_sample_lz_2d_v4f32_f32(c.x, c.y, LOAD_TSHARP(i), LOAD_SSHARP(s));
+}
+
+RATTR float4
+OCKL_MANGLE_T(image_sample_info,2Da)(TSHARP i, SSHARP s, __ockl_image_info_t n, float4 c)
+{
+    ADJUST_XY_INFO(c, n, s);
+    c.z = __builtin_rintf(c.z);
+    return __llvm_amdgcn_image_sample_lz_2darray_v4f32_f32(c.x, c.y, c.z, LOAD_TSHARP(i), LOAD_SSHARP(s));
+}
+
+RATTR float4
+OCKL_MANGLE_T(image_sample_info,3D)(TSHARP i, SSHARP s, __ockl_image_info_t n, float4 c)
+{
+    ADJUST_XYZ_INFO(c, n, s);
+    return __llvm_amdgcn_image_sample_lz_3d_v4f32_f32(c.x, c.y, c.z, LOAD_TSHARP(i), LOAD_SSHARP(s));
+}
+
 RATTR half4
 OCKL_MANGLE_T(image_sampleh,1D)(TSHARP i, SSHARP s, float c)
 {
@@ -838,6 +914,66 @@ OCKL_MANGLE_T(image_gather4a,2D)(TSHARP i, SSHARP s, float2 c)
     return __llvm_amdgcn_image_gather4_lz_2d_v4f32_f32_a(c.x, c.y, LOAD_TSHARP(i), LOAD_SSHARP(s));
 }
 
+RATTR float4
+OCKL_MANGLE_T(image_gather4r,2Da)(TSHARP i, SSHARP s, float4 c)
+{
+    ADJUST_XY(c, i, s);
+    c.z = __builtin_rintf(c.z);
+    return __llvm_amdgcn_image_gather4_lz_2darray_v4f32_f32_r(c.x, c.y, c.z, LOAD_TSHARP(i), LOAD_SSHARP(s));
+}
+
+RATTR float4
+OCKL_MANGLE_T(image_gather4g,2Da)(TSHARP i, SSHARP s, float4 c)
+{
+    ADJUST_XY(c, i, s);
+    c.z = __builtin_rintf(c.z);
+    return __llvm_amdgcn_image_gather4_lz_2darray_v4f32_f32_g(c.x, c.y, c.z, LOAD_TSHARP(i), LOAD_SSHARP(s));
+}
+
+RATTR float4
+OCKL_MANGLE_T(image_gather4b,2Da)(TSHARP i, SSHARP s, float4 c)
+{
+    ADJUST_XY(c, i, s);
+    c.z = __builtin_rintf(c.z);
+    return __llvm_amdgcn_image_gather4_lz_2darray_v4f32_f32_b(c.x, c.y, c.z, LOAD_TSHARP(i), LOAD_SSHARP(s));
+}
+
+RATTR float4
+OCKL_MANGLE_T(image_gather4a,2Da)(TSHARP i, SSHARP s, float4 c)
+{
+    ADJUST_XY(c, i, s);
+    c.z = __builtin_rintf(c.z);
+    return __llvm_amdgcn_image_gather4_lz_2darray_v4f32_f32_a(c.x, c.y, c.z, LOAD_TSHARP(i), LOAD_SSHARP(s));
+}
+
+RATTR float4
+OCKL_MANGLE_T(image_gather4r,CM)(TSHARP i, SSHARP s, float4 c)
+{
+    CUBE_PREP(c);
+    return __llvm_amdgcn_image_gather4_lz_cube_v4f32_f32_r(c.x, c.y, c.z, LOAD_TSHARP(i), LOAD_SSHARP(s));
+}
+
+RATTR float4
+OCKL_MANGLE_T(image_gather4g,CM)(TSHARP i, SSHARP s, float4 c)
+{
+    CUBE_PREP(c);
+    return __llvm_amdgcn_image_gather4_lz_cube_v4f32_f32_g(c.x, c.y, c.z, LOAD_TSHARP(i), LOAD_SSHARP(s));
+}
+
+RATTR float4
+OCKL_MANGLE_T(image_gather4b,CM)(TSHARP i, SSHARP s, float4 c)
+{
+    CUBE_PREP(c);
+    return __llvm_amdgcn_image_gather4_lz_cube_v4f32_f32_b(c.x, c.y, c.z, LOAD_TSHARP(i), LOAD_SSHARP(s));
+}
+
+RATTR float4
+OCKL_MANGLE_T(image_gather4a,CM)(TSHARP i, SSHARP s, float4 c)
+{
+    CUBE_PREP(c);
+    return __llvm_amdgcn_image_gather4_lz_cube_v4f32_f32_a(c.x, c.y, c.z, LOAD_TSHARP(i), LOAD_SSHARP(s));
+}
+
 // We rely on the fact that the runtime allocates 12 words for the T# or V#
 // and fills words 8, 9, and 10 with the data we need to answer all of the queries
 
@@ -884,6 +1020,24 @@ GATTR int OCKL_MANGLE_T(image_height,3D)(TSHARP i)   { return FIELD(i, 78, 14) +
 GATTR int OCKL_MANGLE_T(image_height,CM)(TSHARP i)   { return FIELD(i, 78, 14) + 1U; }
 GATTR int OCKL_MANGLE_T(image_height,CMa)(TSHARP i)  { return FIELD(i, 78, 14) + 1U; }
 
+#define INFO(I,H,D) \
+    __ockl_image_info_t n; \
+    n.width = WORD(I, 10); \
+    n.height = H; \
+    n.depth = D; \
+    n.channel_data_type = WORD(I, 8); \
+    n.channel_order = WORD(I, 9); \
+    n.rwidth = __builtin_amdgcn_rcpf((float)n.width); \
+    n.rheight = __builtin_amdgcn_rcpf((float)n.height); \
+    n.rdepth = __builtin_amdgcn_rcpf((float)n.depth); \
+    return n
+
+GATTR __ockl_image_info_t OCKL_MANGLE_T(image_info,1D)(TSHARP i)  { INFO(i, 1U, 1U); }
+GATTR __ockl_image_info_t OCKL_MANGLE_T(image_info,1Da)(TSHARP i) { INFO(i, 1U, OCKL_MANGLE_T(image_array_size,1Da)(i)); }
+GATTR __ockl_image_info_t OCKL_MANGLE_T(image_info,2D)(TSHARP i)  { INFO(i, OCKL_MANGLE_T(image_height,2D)(i), 1U); }
+GATTR __ockl_image_info_t OCKL_MANGLE_T(image_info,2Da)(TSHARP i) { INFO(i, OCKL_MANGLE_T(image_height,2Da)(i), OCKL_MANGLE_T(image_array_size,2Da)(i)); }
+GATTR __ockl_image_info_t OCKL_MANGLE_T(image_info,3D)(TSHARP i)  { INFO(i, OCKL_MANGLE_T(image_height,3D)(i), OCKL_MANGLE_T(image_depth,3D)(i)); }
+
 GATTR int OCKL_MANGLE_T(image_num_mip_levels,1D)(TSHARP i)   { return FIELD(i, 112, 4); }
 GATTR int OCKL_MANGLE_T(image_num_mip_levels,1Da)(TSHARP i)  { return FIELD(i, 112, 4); }
 GATTR int OCKL_MANGLE_T(image_num_mip_levels,2D)(TSHARP i)   { return FIELD(i, 112, 4); }
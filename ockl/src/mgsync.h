@@ -0,0 +1,38 @@
+/*===--------------------------------------------------------------------------
+ *                   ROCm Device Libraries
+ *
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE.TXT for details.
+ *===------------------------------------------------------------------------*/
+
+// The barrier between the grids of a multi-grid launch, kept apart from
+// cg.cl so that test/ockl/mgsync.c can run it on host threads.
+
+#define AL(P,O,S) __opencl_atomic_load(P,O,S)
+#define AS(P,V,O,S) __opencl_atomic_store(P,V,O,S)
+#define AF(K,P,V,O,S) __opencl_atomic_fetch_##K(P,V,O,S)
+
+// Control block shared by all grids taking part in a multi-grid launch.
+// It is allocated by the host and must be zero initialized.
+struct mg_sync {
+    uint w0; // number of grids which have arrived
+    uint w1; // barrier generation
+};
+
+// Sense reversing barrier across the grids.  The generation must be read
+// before arriving so that the last arrival's bump can't be missed.
+static void
+mg_barrier(__global struct mg_sync *s, uint n)
+{
+    __global atomic_uint *cp = (__global atomic_uint *)&s->w0;
+    __global atomic_uint *gp = (__global atomic_uint *)&s->w1;
+
+    uint g = AL(gp, memory_order_relaxed, memory_scope_all_svm_devices);
+    if (AF(add, cp, 1U, memory_order_acq_rel, memory_scope_all_svm_devices) == n - 1U) {
+        AS(cp, 0U, memory_order_relaxed, memory_scope_all_svm_devices);
+        AS(gp, g + 1U, memory_order_release, memory_scope_all_svm_devices);
+    } else {
+        while (AL(gp, memory_order_acquire, memory_scope_all_svm_devices) == g)
+            __builtin_amdgcn_s_sleep(2);
+    }
+}
@@ -0,0 +1,273 @@
+/*===--------------------------------------------------------------------------
+ *                   ROCm Device Libraries
+ *
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE.TXT for details.
+ *===------------------------------------------------------------------------*/
+
+#include "oclc.h"
+#include "irif.h"
+#include "ockl.h"
+
+#pragma OPENCL EXTENSION cl_khr_int64_base_atomics : enable
+
+#define ATTR __attribute__((always_inline))
+
+#define AS_INT(X) __builtin_astype(X, int)
+#define AS_UINT(X) __builtin_astype(X, uint)
+#define AS_LONG(X) __builtin_astype(X, long)
+#define AS_ULONG(X) __builtin_astype(X, ulong)
+#define AS_FLOAT(X) __builtin_astype(X, float)
+
+// XXX from llvm/include/llvm/IR/InstrTypes.h
+#define ICMP_NE 33
+
+// Hack to prevent incorrect hoisting of the operation. There
+// currently is no proper way in llvm to prevent hoisting of
+// operations control flow dependent results.
+ATTR
+static int optimizationBarrierHack(int in_val)
+{
+    int out_val;
+    __asm__ volatile ("; ockl ballot hoisting hack %0" :
+                      "=v"(out_val) : "0"(in_val));
+    return out_val;
+}
+
+ATTR static ulong
+ballot(bool b)
+{
+    int e = optimizationBarrierHack((int)b);
+    if (__oclc_wavefrontsize64) {
+        return __llvm_amdgcn_icmp_i64_i32(e, 0, ICMP_NE);
+    } else {
+        return (ulong)__llvm_amdgcn_icmp_i32_i32(e, 0, ICMP_NE);
+    }
+}
+
+ATTR static ulong
+activemask(void)
+{
+    if (__oclc_wavefrontsize64) {
+        return __builtin_amdgcn_read_exec();
+    } else {
+        return (ulong)__builtin_amdgcn_read_exec_lo();
+    }
+}
+
+// Number of lanes of m below the current lane
+ATTR static uint
+lanesbelow(ulong m)
+{
+    if (__oclc_wavefrontsize64) {
+        return __builtin_amdgcn_mbcnt_hi((uint)(m >> 32), __builtin_amdgcn_mbcnt_lo((uint)m, 0u));
+    } else {
+        return __builtin_amdgcn_mbcnt_lo((uint)m, 0u);
+    }
+}
+
+ATTR static ulong
+readlane_u64(ulong x, uint i)
+{
+    return ((ulong)__builtin_amdgcn_readlane((uint)(x >> 32), i) << 32) |
+            (ulong)__builtin_amdgcn_readlane((uint)x, i);
+}
+
+// Value of x held by lane i, the lowest lane of the current lane's
+// group m.  Groups must partition the active lanes.  ds_bpermute
+// does not cross the halves of a wave64 on gfx10+, so those fall back
+// to one readlane per group as well.
+ATTR static uint
+grpbcast_u32(uint x, uint i, ulong m)
+{
+    if (__oclc_ISA_version < 8000 ||
+        (__oclc_ISA_version >= 10000 && __oclc_wavefrontsize64)) {
+        ulong r = activemask();
+        uint y = x;
+        while (r) {
+            uint j = (uint)__builtin_ctzl(r);
+            uint t = __builtin_amdgcn_readlane(x, j);
+            y = i == j ? t : y;
+            r &= ~readlane_u64(m, j);
+        }
+        return y;
+    } else {
+        return (uint)__builtin_amdgcn_ds_bpermute((int)(i << 2), (int)x);
+    }
+}
+
+ATTR static ulong
+grpbcast_u64(ulong x, uint i, ulong m)
+{
+    return ((ulong)grpbcast_u32((uint)(x >> 32), i, m) << 32) |
+            (ulong)grpbcast_u32((uint)x, i, m);
+}
+
+ATTR static ulong
+readfirstlane_u64(ulong x)
+{
+    return ((ulong)__builtin_amdgcn_readfirstlane((uint)(x >> 32)) << 32) |
+            (ulong)__builtin_amdgcn_readfirstlane((uint)x);
+}
+
+// One ballot per bit of the value: a lane keeps the lanes that agree
+// with it on that bit.  Bits that every active lane has set, or that
+// none has, cannot split the lanes and are skipped.  Lanes outside exec
+// never appear in a ballot, so the result is the same under any exec.
+ulong
+OCKL_MANGLE_U32(wfmatch_any)(uint x)
+{
+    ulong a = activemask();
+    ulong m = a;
+
+    for (uint b = 0; b < 32; ++b) {
+        bool s = ((x >> b) & 1U) != 0U;
+        ulong v = ballot(s);
+        if (v != 0UL && v != a)
+            m &= s ? v : ~v;
+    }
+
+    return m;
+}
+
+ulong
+OCKL_MANGLE_U64(wfmatch_any)(ulong x)
+{
+    ulong a = activemask();
+    ulong m = a;
+
+    for (uint b = 0; b < 64; ++b) {
+        bool s = ((x >> b) & 1UL) != 0UL;
+        ulong v = ballot(s);
+        if (v != 0UL && v != a)
+            m &= s ? v : ~v;
+    }
+
+    return m;
+}
+
+ulong
+OCKL_MANGLE_U32(wfmatch_all)(uint x)
+{
+    ulong a = activemask();
+    bool same = ballot(x == __builtin_amdgcn_readfirstlane(x)) == a;
+    return same ? a : 0UL;
+}
+
+ulong
+OCKL_MANGLE_U64(wfmatch_all)(ulong x)
+{
+    ulong a = activemask();
+    bool same = ballot(x == readfirstlane_u64(x)) == a;
+    return same ? a : 0UL;
+}
+
+// Increment with one atomic per distinct address in the wave.  Lanes
+// sharing an address see the values they would have seen incrementing
+// one after the other in lane order.
+uint
+OCKL_MANGLE_U32(wfagg_atomic_inc)(__global uint *p)
+{
+    ulong m = OCKL_MANGLE_U64(wfmatch_any)((ulong)p);
+    uint i = (uint)__builtin_ctzl(m);
+    uint r = lanesbelow(m);
+
+    uint o = 0;
+    if (r == 0)
+        o = __opencl_atomic_fetch_add((__global atomic_uint *)p, (uint)__builtin_popcountl(m),
+                                      memory_order_relaxed, memory_scope_device);
+
+    return grpbcast_u32(o, i, m) + r;
+}
+
+#define uint_readlane(X,L) __builtin_amdgcn_readlane(X,L)
+#define int_readlane(X,L) AS_INT(uint_readlane(AS_UINT(X),L))
+#define float_readlane(X,L) AS_FLOAT(uint_readlane(AS_UINT(X),L))
+#define ulong_readlane(X,L) readlane_u64(X,L)
+#define long_readlane(X,L) AS_LONG(readlane_u64(AS_ULONG(X),L))
+
+#define uint_grpbcast(X,I,M) grpbcast_u32(X,I,M)
+#define int_grpbcast(X,I,M) AS_INT(grpbcast_u32(AS_UINT(X),I,M))
+#define float_grpbcast(X,I,M) AS_FLOAT(grpbcast_u32(AS_UINT(X),I,M))
+#define ulong_grpbcast(X,I,M) grpbcast_u64(X,I,M)
+#define long_grpbcast(X,I,M) AS_LONG(grpbcast_u64(AS_ULONG(X),I,M))
+
+#define ATOMIC_ADD(T,P,V) __opencl_atomic_fetch_add((__global atomic_##T *)P, V, memory_order_relaxed, memory_scope_device)
+#define uint_atomic_add(P,V) ATOMIC_ADD(uint,P,V)
+#define int_atomic_add(P,V) ATOMIC_ADD(int,P,V)
+#define ulong_atomic_add(P,V) ATOMIC_ADD(ulong,P,V)
+#define long_atomic_add(P,V) ATOMIC_ADD(long,P,V)
+#define float_atomic_add(P,V) atomic_add_f32(P,V)
+
+ATTR static float
+atomic_add_f32(__global float *p, float v)
+{
+    __global atomic_uint *ap = (__global atomic_uint *)p;
+    uint e = __opencl_atomic_load(ap, memory_order_relaxed, memory_scope_device);
+    uint d;
+    do {
+        d = AS_UINT(AS_FLOAT(e) + v);
+    } while (!__opencl_atomic_compare_exchange_weak(ap, &e, d, memory_order_relaxed,
+                                                    memory_order_relaxed, memory_scope_device));
+    return AS_FLOAT(e);
+}
+
+// Add with one atomic per distinct address in the wave.  The operands of
+// each group of lanes sharing an address are summed and added by the
+// group's lowest lane.  Every lane receives the value it would have seen
+// adding after the lanes below it in its group.
+//
+// When the active lanes are a prefix of the wave one exclusive scan is
+// made per group, so this pays off when few distinct addresses occur,
+// e.g. queue tails or narrow histograms.  The scan is wrong when exec
+// has holes, so then the operands are summed lane by lane with readlane.
+#define GENAGG(T,S) \
+T \
+OCKL_MANGLE_T(wfagg_atomic_add,S)(__global T *p, T x) \
+{ \
+    ulong m = OCKL_MANGLE_U64(wfmatch_any)((ulong)p); \
+    uint l = __ockl_lane_u32(); \
+    ulong a = activemask(); \
+    ulong r = a; \
+    T e = (T)0; \
+    T t = (T)0; \
+ \
+    if ((a & (a + 1UL)) == 0UL) { \
+        while (r) { \
+            uint j = (uint)__builtin_ctzl(r); \
+            ulong g = readlane_u64(m, j); \
+            bool in = (g >> l) & 1UL; \
+            T v = in ? x : (T)0; \
+            T s = OCKL_MANGLE_T(wfscan_add,S)(v, false); \
+            T u = T##_readlane(s + v, 63u - (uint)__builtin_clzl(g)); \
+            e = in ? s : e; \
+            t = in ? u : t; \
+            r &= ~g; \
+        } \
+    } else { \
+        while (r) { \
+            uint j = (uint)__builtin_ctzl(r); \
+            ulong g = readlane_u64(m, j); \
+            T s = (T)0; \
+            for (ulong h = g; h; h &= h - 1UL) { \
+                uint k = (uint)__builtin_ctzl(h); \
+                e = l == k ? s : e; \
+                s += T##_readlane(x, k); \
+            } \
+            t = (g >> l) & 1UL ? s : t; \
+            r &= ~g; \
+        } \
+    } \
+ \
+    T o = (T)0; \
+    if (lanesbelow(m) == 0) \
+        o = T##_atomic_add(p, t); \
+ \
+    return T##_grpbcast(o, (uint)__builtin_ctzl(m), m) + e; \
+}
+
+GENAGG(int,i32)
+GENAGG(uint,u32)
+GENAGG(long,i64)
+GENAGG(ulong,u64)
+GENAGG(float,f32)
@@ -134,6 +134,21 @@
 #define double_readlane(X,L) AS_DOUBLE(ulong_readlane(AS_ULONG(X),L))
 #define half_readlane(X,L) AS_HALF((ushort)uint_readlane((uint)AS_USHORT(X),L))
 
+// bpermute
+#define uint_bpermute(X,L) (uint)__builtin_amdgcn_ds_bpermute((int)(L) << 2, (int)(X))
+#define ulong_bpermute(X,L) ({ \
+    uint2 __x = AS_UINT2(X); \
+    uint2 __r; \
+    __r.lo = uint_bpermute(__x.lo, L); \
+    __r.hi = uint_bpermute(__x.hi, L); \
+    AS_ULONG(__r); \
+})
+#define int_bpermute(X,L) AS_INT(uint_bpermute(AS_UINT(X),L))
+#define long_bpermute(X,L) AS_LONG(ulong_bpermute(AS_ULONG(X),L))
+#define float_bpermute(X,L) AS_FLOAT(uint_bpermute(AS_UINT(X),L))
+#define double_bpermute(X,L) AS_DOUBLE(ulong_bpermute(AS_ULONG(X),L))
+#define half_bpermute(X,L) AS_HALF((ushort)uint_bpermute((uint)AS_USHORT(X),L))
+
 // Select
 #define uint_sel(C,B,A) ({ \
     uint __c = C; \
@@ -463,6 +478,134 @@ GENMAX(ulong)
         s = l == 16 ? v : t; \
     }
 
+// Segmented inclusive scan with operation OP using swizzle
+// Input is x, l is lane, f is first lane of segment, output is s
+#define SEGISCAN_GFX7(T,OP,ID) \
+    T v; \
+ \
+    v = T##_swizzle(x, SWIZZLE_32_LIMITED(0x1e,0x00,0x00)); \
+    v = ((l & 1) && f < l) ? v : ID; \
+    s = T##_##OP(x, v); \
+ \
+    v = T##_swizzle(s, SWIZZLE_32_LIMITED(0x1c,0x01,0x00)); \
+    v = ((l & 2) && f <= ((l & ~0x3u) | 0x1u)) ? v : ID; \
+    s = T##_##OP(s, v); \
+ \
+    v = T##_swizzle(s, SWIZZLE_32_LIMITED(0x18,0x03,0x00)); \
+    v = ((l & 4) && f <= ((l & ~0x7u) | 0x3u)) ? v : ID; \
+    s = T##_##OP(s, v); \
+ \
+    v = T##_swizzle(s, SWIZZLE_32_LIMITED(0x10,0x07,0x00)); \
+    v = ((l & 8) && f <= ((l & ~0xfu) | 0x7u)) ? v : ID; \
+    s = T##_##OP(s, v); \
+ \
+    v = T##_swizzle(s, SWIZZLE_32_LIMITED(0x00,0x0f,0x00)); \
+    v = ((l & 16) && f <= ((l & ~0x1fu) | 0xfu)) ? v : ID; \
+    s = T##_##OP(s, v); \
+ \
+    v = T##_readlane(s, 31); \
+    v = (l > 31 && f < 32) ? v : ID; \
+    s = T##_##OP(s, v)
+
+// Segmented inclusive scan with operation OP using DPP
+// Input is x, l is lane, f is first lane of segment, output is s
+#define SEGISCAN_GFX89(T,OP,ID) \
+    T v; \
+ \
+    v = T##_dpp(ID, x, DPP_ROW_SR(1), 0xf, 0xf, ID == (T)0); \
+    v = f + 1 <= l ? v : ID; \
+    s = T##_##OP(x, v); \
+ \
+    v = T##_dpp(ID, s, DPP_ROW_SR(2), 0xf, 0xf, ID == (T)0); \
+    v = f + 2 <= l ? v : ID; \
+    s = T##_##OP(s, v); \
+ \
+    v = T##_dpp(ID, s, DPP_ROW_SR(4), 0xf, 0xf, ID == (T)0); \
+    v = f + 4 <= l ? v : ID; \
+    s = T##_##OP(s, v); \
+ \
+    v = T##_dpp(ID, s, DPP_ROW_SR(8), 0xf, 0xf, ID == (T)0); \
+    v = f + 8 <= l ? v : ID; \
+    s = T##_##OP(s, v); \
+ \
+    v = T##_dpp(ID, s, DPP_ROW_BCAST15, 0xa, 0xf, false); \
+    v = f < (l & ~0xfu) ? v : ID; \
+    s = T##_##OP(s, v); \
+ \
+    v = T##_dpp(ID, s, DPP_ROW_BCAST31, 0xc, 0xf, false); \
+    v = f < 32 ? v : ID; \
+    s = T##_##OP(s, v); \
+
+// Segmented inclusive scan with operation OP using DPP
+// Input is x, l is lane, f is first lane of segment, output is s
+#define SEGISCAN_GFX10(T,OP,ID) \
+    T v; \
+ \
+    v = T##_dpp(ID, x, DPP_ROW_SR(1), 0xf, 0xf, ID == (T)0); \
+    v = f + 1 <= l ? v : ID; \
+    s = T##_##OP(x, v); \
+ \
+    v = T##_dpp(ID, s, DPP_ROW_SR(2), 0xf, 0xf, ID == (T)0); \
+    v = f + 2 <= l ? v : ID; \
+    s = T##_##OP(s, v); \
+ \
+    v = T##_dpp(ID, s, DPP_ROW_SR(4), 0xf, 0xf, ID == (T)0); \
+    v = f + 4 <= l ? v : ID; \
+    s = T##_##OP(s, v); \
+ \
+    v = T##_dpp(ID, s, DPP_ROW_SR(8), 0xf, 0xf, ID == (T)0); \
+    v = f + 8 <= l ? v : ID; \
+    s = T##_##OP(s, v); \
+ \
+    v = T##_permlanex16(ID, s, 0xffffffff, 0xffffffff, ID == (T)0); \
+    v = ((l & 0x10) && f < (l & ~0xfu)) ? v : ID; \
+    s = T##_##OP(s, v); \
+ \
+    if (__oclc_wavefrontsize64) { \
+        v = T##_readlane(s, 31); \
+        v = (l > 31 && f < 32) ? v : ID; \
+        s = T##_##OP(s, v); \
+    }
+
+#define WAVESIZE() (__oclc_wavefrontsize64 ? 64u : 32u)
+
+// Broadcast the value at the last lane of each segment to the segment
+// using readlane, one iteration per segment.  Used where ds_bpermute is
+// missing (gfx7) or cannot cross the halves of a wave64 (gfx10+)
+// Input is s, h is head mask, e is last lane of segment, output is r
+#define SEGLAST_READLANE(T) \
+    ulong m = (h >> 1) | (1UL << (WAVESIZE() - 1)); \
+    r = s; \
+    while (m) { \
+        uint i = (uint)__builtin_ctzl(m); \
+        T t = T##_readlane(s, i); \
+        r = e == i ? t : r; \
+        m &= m - 1UL; \
+    }
+
+// Mask of segment heads restricted to the wave, lane 0 always a head
+IATTR static ulong
+segheads(ulong h)
+{
+    return (__oclc_wavefrontsize64 ? h : (h & 0xffffffffUL)) | 1UL;
+}
+
+// First lane of the segment containing lane l
+IATTR static uint
+segfirst(ulong h, uint l)
+{
+    ulong m = h & (~0UL >> (63 - l));
+    return 63 - (uint)__builtin_clzl(m);
+}
+
+// Last lane of the segment containing lane l
+IATTR static uint
+seglast(ulong h, uint l)
+{
+    ulong m = l == 63 ? 0UL : (h & (~0UL << (l + 1)));
+    return m ? (uint)__builtin_ctzl(m) - 1 : WAVESIZE() - 1;
+}
+
 IATTR static bool
 fullwave(void)
 {
@@ -520,9 +663,70 @@ C(__ockl_wfscan_,C(OP,T##_suf))(T x, bool inclusive) \
     return s; \
 }
 
+#define SEGISCAN(T,OP,ID) \
+    if (__oclc_ISA_version < 8000) { \
+        SEGISCAN_GFX7(T,OP,ID); \
+    } else  if (__oclc_ISA_version < 10000)  { \
+        SEGISCAN_GFX89(T,OP,ID); \
+    } else { \
+        SEGISCAN_GFX10(T,OP,ID); \
+    }
+
+// Bit i of the wave uniform mask h is set when lane i begins a segment.
+// Every lane of a segment receives the segment's result.
+#define GENSEGRED(T,OP,ID) \
+IATTR T \
+C(__ockl_wfsegred_,C(OP,T##_suf))(T x, ulong h) \
+{ \
+    T s, r; \
+    uint l = __ockl_lane_u32(); \
+    h = segheads(h); \
+    uint f = segfirst(h, l); \
+    uint e = seglast(h, l); \
+ \
+    SEGISCAN(T,OP,ID) \
+ \
+    if (__oclc_ISA_version < 8000 || \
+        (__oclc_ISA_version >= 10000 && __oclc_wavefrontsize64)) { \
+        SEGLAST_READLANE(T); \
+    } else { \
+        r = T##_bpermute(s, e); \
+    } \
+ \
+    return r; \
+}
+
+// Scan restarts at each lane whose bit is set in the wave uniform mask h
+#define GENSEGSCAN(T,OP,ID) \
+IATTR T \
+C(__ockl_wfsegscan_,C(OP,T##_suf))(T x, bool inclusive, ulong h) \
+{ \
+    T s; \
+    uint l = __ockl_lane_u32(); \
+    h = segheads(h); \
+    uint f = segfirst(h, l); \
+ \
+    SEGISCAN(T,OP,ID) \
+ \
+    if (!inclusive) { \
+        if (__oclc_ISA_version < 8000) { \
+            SR1_SWIZZLE(T,ID); \
+        } else  if (__oclc_ISA_version < 10000)  { \
+            SR1_GFX89(T,ID); \
+        } else { \
+            SR1_GFX10(T,ID); \
+        } \
+        s = l == f ? ID : s; \
+    } \
+ \
+    return s; \
+}
+
 #define GEN(T,OP,ID) \
     GENRED(T,OP,ID) \
-    GENSCAN(T,OP,ID)
+    GENSCAN(T,OP,ID) \
+    GENSEGRED(T,OP,ID) \
+    GENSEGSCAN(T,OP,ID)
 
 GEN(int,add,0)
 GEN(uint,add,0u)
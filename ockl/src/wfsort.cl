@@ -0,0 +1,205 @@
+/*===--------------------------------------------------------------------------
+ *                   ROCm Device Libraries
+ *
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE.TXT for details.
+ *===------------------------------------------------------------------------*/
+
+#include "irif.h"
+#include "ockl.h"
+#include "oclc.h"
+
+#define AS_UINT(X) __builtin_astype(X, uint)
+#define AS_FLOAT(X) __builtin_astype(X, float)
+
+// Swizzle offset macros
+#define SWIZZLE_32_LIMITED(ANDM,ORM,XORM) (uint)((XORM << 10) | (ORM << 5) | ANDM)
+
+// DPP 9 bit control macros
+#define DPP_QUAD_PERM(S0,S1,S2,S3) (uint)((S3 << 6) | (S2 << 4) | (S1 << 2) | S0)
+#define DPP_ROW_XMASK(N) (uint)(0x160 | N)
+
+#define uint_swizzle(X,Y) __builtin_amdgcn_ds_swizzle(X, Y)
+#define uint_dpp(X,C) __llvm_amdgcn_update_dpp_i32(0u, X, C, 0xf, 0xf, false)
+#define uint_permlanex16(X) __llvm_amdgcn_permlanex16(0u, X, 0x76543210, 0xfedcba98, false, false)
+#define uint_bpermute(X,L) (uint)__builtin_amdgcn_ds_bpermute((int)(L) << 2, (int)(X))
+
+#define WAVESIZE() (__oclc_wavefrontsize64 ? 64u : 32u)
+
+#define IATTR
+
+// Exchange the two 32 lane halves of a wave64 with readlane where no
+// cross half permute is available
+IATTR static uint
+xchg32_readlane(uint x, uint l)
+{
+    uint y = x;
+    for (uint i = 0; i < 32; ++i) {
+        uint a = __builtin_amdgcn_readlane(x, i);
+        uint b = __builtin_amdgcn_readlane(x, i + 32);
+        y = l == i ? b : y;
+        y = l == i + 32 ? a : y;
+    }
+    return y;
+}
+
+// Value of x in lane l ^ j, j is a wave uniform power of 2
+IATTR static uint
+xchg(uint x, uint j, uint l)
+{
+    switch (j) {
+    case 1:
+        if (__oclc_ISA_version < 8000)
+            return uint_swizzle(x, SWIZZLE_32_LIMITED(0x1f,0x00,0x01));
+        return uint_dpp(x, DPP_QUAD_PERM(0x1,0x0,0x3,0x2));
+    case 2:
+        if (__oclc_ISA_version < 8000)
+            return uint_swizzle(x, SWIZZLE_32_LIMITED(0x1f,0x00,0x02));
+        return uint_dpp(x, DPP_QUAD_PERM(0x2,0x3,0x0,0x1));
+    case 4:
+        if (__oclc_ISA_version < 10000)
+            return uint_swizzle(x, SWIZZLE_32_LIMITED(0x1f,0x00,0x04));
+        return uint_dpp(x, DPP_ROW_XMASK(0x4));
+    case 8:
+        if (__oclc_ISA_version < 10000)
+            return uint_swizzle(x, SWIZZLE_32_LIMITED(0x1f,0x00,0x08));
+        return uint_dpp(x, DPP_ROW_XMASK(0x8));
+    case 16:
+        if (__oclc_ISA_version < 10000)
+            return uint_swizzle(x, SWIZZLE_32_LIMITED(0x1f,0x00,0x10));
+        return uint_permlanex16(x);
+    default:
+        if (__oclc_ISA_version < 8000 || __oclc_ISA_version >= 10000)
+            return xchg32_readlane(x, l);
+        return uint_bpermute(x, l ^ 32u);
+    }
+}
+
+// Order preserving map of float bits to uint
+IATTR static uint
+f2key(float x)
+{
+    uint u = AS_UINT(x);
+    return u ^ ((u >> 31) ? 0xffffffffu : 0x80000000u);
+}
+
+IATTR static float
+key2f(uint u)
+{
+    return AS_FLOAT(u ^ ((u >> 31) ? 0x80000000u : 0xffffffffu));
+}
+
+// One compare exchange step with the lane j away.  The lower lane of
+// the pair keeps the smaller value when sorting ascending.
+IATTR static uint
+cmpx(uint x, uint j, uint l, bool asc)
+{
+    uint y = xchg(x, j, l);
+    bool keepmin = ((l & j) == 0) == asc;
+    uint lo = x < y ? x : y;
+    uint hi = x < y ? y : x;
+    return keepmin ? lo : hi;
+}
+
+// Bitonic merge of the bitonic sequences of m lanes
+IATTR static uint
+merge(uint x, uint m, uint l, bool asc)
+{
+    for (uint j = m >> 1; j > 0; j >>= 1)
+        x = cmpx(x, j, l, asc);
+    return x;
+}
+
+// Bitonic sort of the blocks of m lanes, block direction taken from the
+// lane bit m, i.e. alternating blocks, or dsc when m is the wave size
+IATTR static uint
+bsort(uint x, uint m, uint l, bool dsc)
+{
+    for (uint k = 2; k <= m; k <<= 1) {
+        bool asc = k == WAVESIZE() ? !dsc : (l & k) == 0;
+        x = merge(x, k, l, asc);
+    }
+    return x;
+}
+
+// The whole wave must be active
+uint
+OCKL_MANGLE_U32(wfsort)(uint x, bool descending)
+{
+    uint l = __ockl_lane_u32();
+    return bsort(x, WAVESIZE(), l, descending);
+}
+
+float
+OCKL_MANGLE_F32(wfsort)(float x, bool descending)
+{
+    uint l = __ockl_lane_u32();
+    return key2f(bsort(f2key(x), WAVESIZE(), l, descending));
+}
+
+// Sort keys k carrying values v, returned as (key, value).  Ties keep
+// their own pair so no pair is ever duplicated or lost.
+uint2
+OCKL_MANGLE_T(wfsort_kv,u32)(uint k, uint v, bool descending)
+{
+    uint l = __ockl_lane_u32();
+
+    for (uint s = 2; s <= WAVESIZE(); s <<= 1) {
+        bool asc = s == WAVESIZE() ? !descending : (l & s) == 0;
+        for (uint j = s >> 1; j > 0; j >>= 1) {
+            uint yk = xchg(k, j, l);
+            uint yv = xchg(v, j, l);
+            bool keepmin = ((l & j) == 0) == asc;
+            bool take = keepmin ? yk < k : yk > k;
+            k = take ? yk : k;
+            v = take ? yv : v;
+        }
+    }
+
+    return (uint2)(k, v);
+}
+
+// Largest n values of the wave in descending order in lanes 0 to n-1,
+// other lanes are left unspecified.  n must be wave uniform.
+//
+// Blocks of m >= n lanes are sorted in alternating direction, then pairs
+// of blocks are folded with an elementwise max, which leaves a bitonic
+// block holding the top m of the pair, and merged again.  This costs
+// log2(m)*(log2(m)+1)/2 + log2(W/m)*(log2(m)+1) steps instead of the
+// log2(W)*(log2(W)+1)/2 of a full sort.
+IATTR static uint
+topk(uint x, uint n)
+{
+    uint l = __ockl_lane_u32();
+    uint w = WAVESIZE();
+    uint m = 1;
+    while (m < n)
+        m <<= 1;
+
+    if (m >= w)
+        return bsort(x, w, l, true);
+
+    x = bsort(x, m, l, true);
+
+    for (uint s = m; s < w; s <<= 1) {
+        uint y = xchg(x, s, l);
+        x = x < y ? y : x;
+        bool asc = (s << 1) == w ? false : (l & (s << 1)) == 0;
+        x = merge(x, m, l, asc);
+    }
+
+    return x;
+}
+
+uint
+OCKL_MANGLE_U32(wftopk)(uint x, uint n)
+{
+    return topk(x, n);
+}
+
+float
+OCKL_MANGLE_F32(wftopk)(float x, uint n)
+{
+    return key2f(topk(f2key(x), n));
+}
+
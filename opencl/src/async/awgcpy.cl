@@ -21,12 +21,36 @@
         dst[D] = src[S]; \
     return e
 
+// Contiguous copy, moved 16 bytes at a time when both ends are 16 byte
+// aligned, with any remaining elements copied one by one
+#define CBODY(DA,SA) \
+    size_t i; \
+    size_t d = mul24(mul24((int)get_local_size(0), (int)get_local_size(1)), (int)get_local_size(2)); \
+    size_t i0 = 0; \
+    if ((((size_t)dst | (size_t)src) & 15) == 0) { \
+        size_t n16 = (n * sizeof(*dst)) >> 4; \
+        for (i = get_local_linear_id(); i<n16; i += d) \
+            ((DA uint4 *)dst)[i] = ((const SA uint4 *)src)[i]; \
+        i0 = (n16 << 4) / sizeof(*dst); \
+    } \
+    for (i = i0 + get_local_linear_id(); i<n; i += d) \
+        dst[i] = src[i]; \
+    return e
+
+
+// A unit stride is a contiguous copy
+#define SBODY(D,S,DA,SA) \
+    if (j == 1) { \
+        CBODY(DA,SA); \
+    } else { \
+        BODY(D,S); \
+    }
 
 #define GENIN(N,T) \
 IATTR static event_t \
 gli_##T##N(__global T##N *dst, const __local T##N *src, size_t n, event_t e) \
 { \
-    BODY(i,i); \
+    CBODY(__global,__local); \
 } \
 extern AATTR(S(gli_##T##N)) event_t async_work_group_copy(__global u##T##N *, const __local u##T##N *, size_t, event_t); \
 extern AATTR(S(gli_##T##N)) event_t async_work_group_copy(__global T##N *, const __local T##N *, size_t, event_t); \
@@ -34,7 +58,7 @@ extern AATTR(S(gli_##T##N)) event_t async_work_group_copy(__global T##N *, const
 IATTR static event_t \
 lgi_##T##N(__local T##N *dst, const __global T##N *src, size_t n, event_t e) \
 { \
-    BODY(i,i); \
+    CBODY(__local,__global); \
 } \
 extern AATTR(S(lgi_##T##N)) event_t async_work_group_copy(__local u##T##N *, const __global u##T##N *, size_t, event_t); \
 extern AATTR(S(lgi_##T##N)) event_t async_work_group_copy(__local T##N *, const __global T##N *, size_t, event_t); \
@@ -42,7 +66,7 @@ extern AATTR(S(lgi_##T##N)) event_t async_work_group_copy(__local T##N *, const
 IATTR static event_t \
 sgli_##T##N(__global T##N *dst, const __local T##N *src, size_t n, size_t j, event_t e) \
 { \
-    BODY(i*j,i); \
+    SBODY(i*j,i,__global,__local) \
 } \
 extern AATTR(S(sgli_##T##N)) event_t async_work_group_strided_copy(__global u##T##N *, const __local u##T##N *, size_t, size_t, event_t); \
 extern AATTR(S(sgli_##T##N)) event_t async_work_group_strided_copy(__global T##N *, const __local T##N *, size_t, size_t, event_t); \
@@ -50,7 +74,7 @@ extern AATTR(S(sgli_##T##N)) event_t async_work_group_strided_copy(__global T##N
 IATTR static event_t \
 slgi_##T##N(__local T##N *dst, const __global T##N *src, size_t n, size_t j, event_t e) \
 { \
-    BODY(i,i*j); \
+    SBODY(i,i*j,__local,__global) \
 } \
 extern AATTR(S(slgi_##T##N)) event_t async_work_group_strided_copy(__local u##T##N *, const __global u##T##N *, size_t, size_t, event_t); \
 extern AATTR(S(slgi_##T##N)) event_t async_work_group_strided_copy(__local T##N *, const __global T##N *, size_t, size_t, event_t);
@@ -72,25 +96,25 @@ GENI(long)
 ATTR event_t \
 async_work_group_copy(__global T##N *dst, const __local T##N *src, size_t n, event_t e) \
 { \
-    BODY(i,i); \
+    CBODY(__global,__local); \
 } \
  \
 ATTR event_t \
 async_work_group_copy(__local T##N *dst, const __global T##N *src, size_t n, event_t e) \
 { \
-    BODY(i,i); \
+    CBODY(__local,__global); \
 } \
  \
 ATTR event_t \
 async_work_group_strided_copy(__global T##N *dst, const __local T##N *src, size_t n, size_t j, event_t e) \
 { \
-    BODY(i*j,i); \
+    SBODY(i*j,i,__global,__local) \
 } \
  \
 ATTR event_t \
 async_work_group_strided_copy(__local T##N *dst, const __global T##N *src, size_t n, size_t j, event_t e) \
 { \
-    BODY(i,i*j); \
+    SBODY(i,i*j,__local,__global) \
 } \
 
 #define GENF(T) \
@@ -1,6 +1,7 @@
 
 #include "irif.h"
 #include "device_amd_hsa.h"
+#include "ockl.h"
 
 #pragma OPENCL EXTENSION cl_amd_media_ops2 : enable
 #pragma OPENCL EXTENSION cl_khr_int64_base_atomics : enable
@@ -35,9 +36,41 @@ typedef struct _AmdVQueueHeader {
     uint    arg_size;           //!< [LRO] The size of argument buffer (in bytes)
     uint    mask_groups;        //!< [LRO] The mask group size
     ulong   kernel_table;       //!< [LRO] Pointer to an array with all kernel objects (ulong for each entry)
-    uint    reserved[2];        //!< For the future usage
+    uint    ext_magic;          //!< [LRO/SRO] AMD_VQUEUE_EXT_MAGIC when ext_offset is valid
+    uint    ext_offset;         //!< [LRO/SRO] Offset in bytes of an AmdVQueueExt from the header
 } AmdVQueueHeader;
 
+//! "VQX1", written by runtimes which fill in an AmdVQueueExt.  Any other
+//! value of ext_magic, including the 0 of older runtimes, means no extension.
+#define AMD_VQUEUE_EXT_MAGIC 0x31585156U
+
+//! Optional features of the queue.  A field is only valid when size covers it.
+typedef struct _AmdVQueueExt {
+    uint    size;               //!< [LRO/SRO] The number of bytes the runtime filled in
+    uint    reserved;           //!< For the future usage
+    ulong   ready_list;         //!< [LRO/SRO] Pointer to an AmdReadyList, or 0 to have the
+                                // scheduler scan aql_slot_mask
+    ulong   profile_ring;       //!< [LRO/SRO] Pointer to an AmdProfileRing to log child
+                                // dispatches to, or 0
+} AmdVQueueExt;
+
+//! Ring of the AQL slots waiting for the scheduler.  Enqueue pushes a slot
+//! once it is READY or MARKER and the scheduler pushes back the slots it
+//! did not retire.  A slot is never listed twice, so a ring of at least
+//! aql_slot_num entries cannot overflow.  A scheduler pass only takes the
+//! entries listed before it started, so that no slot is visited twice in
+//! one pass.
+typedef struct _AmdReadyList {
+    uint    size;               //!< [LRO/SRO] The number of entries, a power of 2 >= aql_slot_num
+    uint    reserved;           //!< For the future usage
+    ulong   head;               //!< [SRW] Position of the next entry to take
+    ulong   tail;               //!< [LRW/SRW] Position of the next entry to fill
+    ulong   pass_end;           //!< [SRW] Position the running pass takes entries up to,
+                                // 0 until its first work-item sets it
+    ulong   pass_done;          //!< [SRW] The number of scheduler work-items which ended a pass
+    uint    entries[1];         //!< [LRW/SRW] Slot index + 1, 0 while the entry is empty
+} AmdReadyList;
+
 typedef struct _AmdAqlWrap {
     uint state;             //!< [LRW/SRW] The current state of the AQL wrapper:  FREE, RESERVED, READY,
                             // MARKER, BUSY and DONE. The block could be returned back to a free state.
@@ -55,7 +88,10 @@ typedef struct _AmdAqlWrap {
     ulong parent_wrap;      //!< [LWO/SRO] Pointer to the parent AQL wrapper (AmdAqlWrap*)
     ulong wait_list;        //!< [LRO/SRO] Pointer to an array of clk_event_t objects (64 bytes default)
     uint wait_num;          //!<  [LWO/SRO] The number of cl_event_wait objects 
-    uint reserved[5];       //!< For the future usage
+    uint wait_done;         //!< [LWO/SRW] The number of leading wait_list events already seen
+                            // complete and released, the pending dependencies are the rest
+    ulong queued_time;      //!< [LWO/SRO] __ockl_memrealtime_u64() when the wrap was submitted
+    uint reserved[2];       //!< For the future usage
     hsa_kernel_dispatch_packet_t aql;  //!< [LWO/SRO] AQL packet - 64 bytes AQL packet
 } AmdAqlWrap;
 
@@ -66,6 +102,35 @@ typedef struct _AmdEvent {
     ulong capture_info;     //!< [LRW/SRO] Profiling capture info for CLK_PROFILING_COMMAND_EXEC_TIME
 } AmdEvent;
 
+//! Profiling record kinds
+enum ProfileKind {
+    PROFILE_QUEUED = 0,
+    PROFILE_START,
+    PROFILE_END,
+    PROFILE_COMPLETE
+};
+
+typedef struct _AmdProfileRecord {
+    ulong time;             //!< [SWO] __ockl_memrealtime_u64() at the transition
+    uint command_id;        //!< [SWO] The command_id of the wrap
+    uint kind;              //!< [SWO] The ProfileKind of the transition
+    uint stamp;             //!< [SWO] Low 32 bits of the record position + 1, written last.
+                            // The record at position i is valid once stamp == (uint)(i + 1)
+    uint reserved;          //!< For the future usage
+} AmdProfileRecord;
+
+//! Ring the scheduler logs every child dispatch to.  The host drains it
+//! by advancing read_index; records are dropped rather than waited for
+//! when the ring is full.
+typedef struct _AmdProfileRing {
+    uint size;              //!< [LRO/SRO] The number of records, a power of 2
+    uint reserved;          //!< For the future usage
+    ulong write_index;      //!< [LRO/SRW] The number of records produced
+    ulong read_index;       //!< [LRW/SRO] The number of records consumed by the host
+    ulong dropped;          //!< [LRO/SRW] The number of records lost to a full ring
+    AmdProfileRecord records[1];
+} AmdProfileRing;
+
 // XXX this needs to match workgroup/wg.h MAX_WAVES_PER_SIMD
 #define CL_DEVICE_MAX_WORK_GROUP_SIZE 256
 
@@ -91,27 +156,55 @@ get_aql_wrap(void)
     return (__global AmdAqlWrap *)(((__constant size_t *)__builtin_amdgcn_implicitarg_ptr())[5]);
 }
 
+// Field F of the queue extension, or 0 when the runtime did not provide it
+#define VQUEUE_EXT(VQ,F) get_vqueue_ext(VQ, __builtin_offsetof(AmdVQueueExt, F))
+
+static inline ulong
+get_vqueue_ext(__global AmdVQueueHeader *vq, uint off)
+{
+    if (vq->ext_magic != AMD_VQUEUE_EXT_MAGIC)
+        return 0UL;
+
+    __global AmdVQueueExt *x = (__global AmdVQueueExt *)((__global uchar *)vq + vq->ext_offset);
+    if (x->size < off + (uint)sizeof(ulong))
+        return 0UL;
+
+    return *(__global ulong *)((__global uchar *)x + off);
+}
+
 // reserve a slot in a bitmask controlled resource
 // n is the number of slots
+//
+// The active lanes of a wave start on different words, rank r of them
+// on the r-th mask group after the one of the wave's first lane, so the
+// slots of one wave are spread over the scheduler's mask groups and all
+// lanes take their bit with one fetch-or in parallel.  Once the lanes
+// outnumber the groups the starting words wrap around, shifted by one
+// word per lap.  A lane that loses its bit to another lane tries the
+// next free bit the fetch-or returned, then the following words.
 static inline int
 reserve_slot(__global uint * restrict mask, uint n, uint mask_groups)
 {
     n >>= 5;
-    uint j, k, v, vv, z;
+    ulong g = __builtin_amdgcn_read_exec();
+    uint r = __builtin_amdgcn_mbcnt_hi((uint)(g >> 32), __builtin_amdgcn_mbcnt_lo((uint)g, 0u));
+    uint j, k, t, v, z;
 
     // Spread the starting points
-    k = (get_local_linear_id() * mask_groups) % n;
+    t = (__builtin_amdgcn_readfirstlane(get_local_linear_id()) + r) * mask_groups;
+    k = (t + t / n) % n;
 
     // Make only one pass
-    for (j=0;j<n;++j) {
+    for (j=0; j<n; ++j) {
         __global atomic_uint *p = (__global atomic_uint *)(mask + k);
         v = atomic_load_explicit(p, memory_order_relaxed, memory_scope_device);
         for (;;) {
             z = ctz(~v);
             if (z == 32U)
                 break;
-            vv = v | (1U << z);
-            if (atomic_compare_exchange_strong_explicit(p, &v, vv, memory_order_relaxed, memory_order_relaxed, memory_scope_device))
+            uint b = 1U << z;
+            v = atomic_fetch_or_explicit(p, b, memory_order_relaxed, memory_scope_device);
+            if ((v & b) == 0U)
                 break;
         }
         if (z < 32U)
@@ -147,3 +240,94 @@ align_up(uint start, uint align)
     return (start + align - 1U) & -align;
 }
 
+// Hand slot i to the scheduler
+static inline void
+ready_push(__global AmdReadyList *rl, uint i)
+{
+    ulong t = atomic_fetch_add_explicit((__global atomic_ulong *)&rl->tail, 1UL, memory_order_relaxed, memory_scope_device);
+    __global atomic_uint *e = (__global atomic_uint *)&rl->entries[t & (ulong)(rl->size - 1U)];
+
+    // The taker of the previous use of this entry may not have emptied it yet
+    uint v = 0;
+    while (!atomic_compare_exchange_strong_explicit(e, &v, i + 1U, memory_order_release, memory_order_relaxed, memory_scope_device))
+        v = 0;
+}
+
+// Take a slot from positions below end, or return -1 when there are none
+static inline int
+ready_pop(__global AmdReadyList *rl, ulong end)
+{
+    __global atomic_ulong *ph = (__global atomic_ulong *)&rl->head;
+    ulong h = atomic_load_explicit(ph, memory_order_relaxed, memory_scope_device);
+    do {
+        if (h >= end)
+            return -1;
+    } while (!atomic_compare_exchange_strong_explicit(ph, &h, h + 1UL, memory_order_relaxed, memory_order_relaxed, memory_scope_device));
+
+    // The pusher of this position may not have filled it yet
+    __global atomic_uint *e = (__global atomic_uint *)&rl->entries[h & (ulong)(rl->size - 1U)];
+    uint v;
+    do {
+        v = atomic_exchange_explicit(e, 0U, memory_order_acquire, memory_scope_device);
+    } while (v == 0U);
+
+    return (int)(v - 1U);
+}
+
+// The end of the entries the current scheduler pass takes from, which the
+// first of its work-items to get here sets to the tail
+static inline ulong
+ready_pass_begin(__global AmdReadyList *rl)
+{
+    __global atomic_ulong *pe = (__global atomic_ulong *)&rl->pass_end;
+    ulong e = atomic_load_explicit(pe, memory_order_relaxed, memory_scope_device);
+    if (e == 0UL) {
+        ulong t = atomic_load_explicit((__global atomic_ulong *)&rl->tail, memory_order_relaxed, memory_scope_device);
+        if (atomic_compare_exchange_strong_explicit(pe, &e, t, memory_order_relaxed, memory_order_relaxed, memory_scope_device))
+            e = t;
+    }
+    return e;
+}
+
+// Called by each of the n work-items of a scheduler pass when it is done;
+// the last one clears pass_end for the next pass
+static inline void
+ready_pass_end(__global AmdReadyList *rl, ulong n)
+{
+    ulong d = atomic_fetch_add_explicit((__global atomic_ulong *)&rl->pass_done, 1UL, memory_order_relaxed, memory_scope_device);
+    if ((d + 1UL) % n == 0UL)
+        atomic_store_explicit((__global atomic_ulong *)&rl->pass_end, 0UL, memory_order_relaxed, memory_scope_device);
+}
+
+// Log one transition of a child dispatch.  Only take a position once
+// there is room so the ring has no holes; when it is full the record is
+// counted as dropped instead.
+static inline void
+profile_ring_put(__global AmdProfileRing *ring, uint command_id, uint kind, ulong time)
+{
+    __global atomic_ulong *pw = (__global atomic_ulong *)&ring->write_index;
+    ulong w = atomic_load_explicit(pw, memory_order_relaxed, memory_scope_device);
+
+    do {
+        ulong r = atomic_load_explicit((__global atomic_ulong *)&ring->read_index, memory_order_acquire, memory_scope_all_svm_devices);
+        if (w - r >= (ulong)ring->size) {
+            atomic_fetch_add_explicit((__global atomic_ulong *)&ring->dropped, 1UL, memory_order_relaxed, memory_scope_device);
+            return;
+        }
+    } while (!atomic_compare_exchange_strong_explicit(pw, &w, w + 1UL, memory_order_relaxed, memory_order_relaxed, memory_scope_device));
+
+    __global AmdProfileRecord *rec = &ring->records[w & (ulong)(ring->size - 1U)];
+    rec->time = time;
+    rec->command_id = command_id;
+    rec->kind = kind;
+    atomic_store_explicit((__global atomic_uint *)&rec->stamp, (uint)(w + 1UL), memory_order_release, memory_scope_all_svm_devices);
+}
+
+// Tell the scheduler about a wrap which just became READY or MARKER
+static inline void
+notify_scheduler(__global AmdVQueueHeader *vq, uint i)
+{
+    ulong rl = VQUEUE_EXT(vq, ready_list);
+    if (rl != 0UL)
+        ready_push((__global AmdReadyList *)rl, i);
+}
@@ -158,11 +158,15 @@ enqueue_marker(queue_t q, uint nwl, const clk_event_t *wl, clk_event_t *ce)
 
     aw->wait_num = nwl;
 
+    aw->wait_done = 0;
+    aw->queued_time = __ockl_memrealtime_u64();
+
     // A marker is never enqueued so ignore displatch packet
 
     // Tell the scheduler
     atomic_fetch_add_explicit((__global atomic_uint *)&me->child_counter, (uint)1, memory_order_relaxed, memory_scope_device);
     atomic_store_explicit((__global atomic_uint *)&aw->state, AQL_WRAP_MARKER, memory_order_release, memory_scope_device);
+    notify_scheduler(vq, (uint)ai);
 
     *ce = __builtin_astype(ev, clk_event_t);
     return 0;
@@ -206,6 +210,8 @@ __enqueue_kernel_basic(queue_t q, kernel_enqueue_flags_t f, const ndrange_t r, v
     aw->completion = 0UL;
     aw->parent_wrap = (ulong)me;
     aw->wait_num = 0;
+    aw->wait_done = 0;
+    aw->queued_time = __ockl_memrealtime_u64();
     aw->aql.header = (0x1 << 11) | (0x1 << 9) |(0x0 << 8) | (0x2 << 0);
     aw->aql.setup = r.workDimension;
     aw->aql.workgroup_size_x = (ushort)r.localWorkSize[0];
@@ -221,6 +227,7 @@ __enqueue_kernel_basic(queue_t q, kernel_enqueue_flags_t f, const ndrange_t r, v
 
     atomic_fetch_add_explicit((__global atomic_uint *)&me->child_counter, (uint)1, memory_order_relaxed, memory_scope_device);
     atomic_store_explicit((__global atomic_uint *)&aw->state, AQL_WRAP_READY, memory_order_release, memory_scope_device);
+    notify_scheduler(vq, (uint)ai);
     return 0;
 }
 
@@ -282,6 +289,8 @@ __enqueue_kernel_basic_events(queue_t q, kernel_enqueue_flags_t f, const ndrange
     if (nwl > 0)
         copy_retain_waitlist((__global size_t *)aw->wait_list, (const size_t *)wl, nwl);
     aw->wait_num = nwl;
+    aw->wait_done = 0;
+    aw->queued_time = __ockl_memrealtime_u64();
     aw->aql.header = (ushort)((0x1 << 11) | (0x1 << 9) |(0x0 << 8) | (0x2 << 0));
     aw->aql.setup = (ushort)r.workDimension;
     aw->aql.workgroup_size_x = (ushort)r.localWorkSize[0];
@@ -297,6 +306,7 @@ __enqueue_kernel_basic_events(queue_t q, kernel_enqueue_flags_t f, const ndrange
 
     atomic_fetch_add_explicit((__global atomic_uint *)&me->child_counter, (uint)1, memory_order_relaxed, memory_scope_device);
     atomic_store_explicit((__global atomic_uint *)&aw->state, AQL_WRAP_READY, memory_order_release, memory_scope_device);
+    notify_scheduler(vq, (uint)ai);
     return 0;
 }
 
@@ -350,6 +360,8 @@ __enqueue_kernel_varargs(queue_t q, kernel_enqueue_flags_t f, const ndrange_t r,
     aw->completion = 0UL;
     aw->parent_wrap = (ulong)me;
     aw->wait_num = 0;
+    aw->wait_done = 0;
+    aw->queued_time = __ockl_memrealtime_u64();
     aw->aql.header = (0x1 << 11) | (0x1 << 9) |(0x0 << 8) | (0x2 << 0);
     aw->aql.setup = r.workDimension;
     aw->aql.workgroup_size_x = (ushort)r.localWorkSize[0];
@@ -365,6 +377,7 @@ __enqueue_kernel_varargs(queue_t q, kernel_enqueue_flags_t f, const ndrange_t r,
 
     atomic_fetch_add_explicit((__global atomic_uint *)&me->child_counter, (uint)1, memory_order_relaxed, memory_scope_device);
     atomic_store_explicit((__global atomic_uint *)&aw->state, AQL_WRAP_READY, memory_order_release, memory_scope_device);
+    notify_scheduler(vq, (uint)ai);
     return 0;
 }
 
@@ -440,6 +453,8 @@ __enqueue_kernel_events_varargs(queue_t q, kernel_enqueue_flags_t f, const ndran
     if (nwl > 0)
         copy_retain_waitlist((__global size_t *)aw->wait_list, (const size_t *)wl, nwl);
     aw->wait_num = nwl;
+    aw->wait_done = 0;
+    aw->queued_time = __ockl_memrealtime_u64();
     aw->aql.header = (0x1 << 11) | (0x1 << 9) |(0x0 << 8) | (0x2 << 0);
     aw->aql.setup = r.workDimension;
     aw->aql.workgroup_size_x = (ushort)r.localWorkSize[0];
@@ -455,6 +470,7 @@ __enqueue_kernel_events_varargs(queue_t q, kernel_enqueue_flags_t f, const ndran
 
     atomic_fetch_add_explicit((__global atomic_uint *)&me->child_counter, (uint)1, memory_order_relaxed, memory_scope_device);
     atomic_store_explicit((__global atomic_uint *)&aw->state, AQL_WRAP_READY, memory_order_release, memory_scope_device);
+    notify_scheduler(vq, (uint)ai);
     return 0;
 }
 
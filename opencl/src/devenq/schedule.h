@@ -0,0 +1,235 @@
+
+// AQL wrap state machine shared by the schedulers.  The including file
+// defines SchedulerParam, which must have an eng_clk member, and
+//
+//   void launchDispatch(__global SchedulerParam* param, ulong ctx,
+//                       __global hsa_kernel_dispatch_packet_t* aqlPkt);
+//   void profileRecord(__global SchedulerParam* param, uint commandId,
+//                      uint kind, ulong time);
+//
+// ctx is passed through from schedule_pass untouched for the backend.
+
+static inline void
+releaseEvent(__global AmdEvent* ev, __global uint* emask, __global AmdEvent* eb)
+{
+    uint c = atomic_fetch_sub_explicit((__global atomic_uint *)&ev->counter, 1U, memory_order_relaxed, memory_scope_device);
+    if (c == 1U) {
+        uint i = ev - eb;
+        release_slot(emask, i);
+    }
+}
+
+static inline void
+releaseWaitEvents(__global AmdEvent** events, uint numEvents, __global uint* emask, __global AmdEvent* eb)
+{
+    for (uint i = 0; i < numEvents; ++i) {
+        releaseEvent(events[i], emask, eb);
+    }
+}
+
+// Move the wait cursor of disp past the completed events at the front of
+// its wait list, releasing each one as it is passed.  An event is thus
+// looked at until it completes and never again, rather than on every
+// pass.  Returns 1 once no dependency is pending, -1 if an event failed
+// and 0 otherwise.
+static inline int
+advanceWaitEvents(__global AmdAqlWrap* disp, __global uint* emask, __global AmdEvent* eb)
+{
+    __global AmdEvent** events = (__global AmdEvent**)(disp->wait_list);
+    uint i = disp->wait_done;
+
+    for (; i < disp->wait_num; ++i) {
+        int status = atomic_load_explicit((__global atomic_uint*)(&events[i]->state), memory_order_relaxed, memory_scope_device);
+        if (status != CL_COMPLETE) {
+            disp->wait_done = i;
+            return status < 0 ? -1 : 0;
+        }
+        releaseEvent(events[i], emask, eb);
+    }
+
+    disp->wait_done = i;
+    return 1;
+}
+
+// Release the events disp still holds
+static inline void
+releasePendingEvents(__global AmdAqlWrap* disp, __global uint* emask, __global AmdEvent* eb)
+{
+    releaseWaitEvents((__global AmdEvent**)(disp->wait_list) + disp->wait_done, disp->wait_num - disp->wait_done, emask, eb);
+    disp->wait_done = disp->wait_num;
+}
+
+static inline uint
+min_command(uint slot_num, __global AmdAqlWrap* wraps)
+{
+    uint minCommand = 0xffffffff;
+    for (uint idx = 0; idx < slot_num; ++idx) {
+        __global AmdAqlWrap* disp = (__global AmdAqlWrap*)&wraps[idx];
+        uint slotState = atomic_load_explicit((__global atomic_uint*)(&disp->state), memory_order_relaxed, memory_scope_device);
+        if ((slotState != AQL_WRAP_FREE) && (slotState != AQL_WRAP_RESERVED)) {
+            minCommand = min(disp->command_id, minCommand);
+        }
+    }
+    return minCommand;
+}
+
+// Advance the wrap in slot idx.  Returns nonzero when the wrap was taken
+// off its wait list, positive if it was also launched, and sets *live
+// when the slot is still in use afterwards.
+static inline int
+schedule_slot(__global SchedulerParam* param, ulong ctx, __global AmdVQueueHeader* queue, __global AmdAqlWrap* wraps, uint idx, bool* live)
+{
+    __global uint* amask = (__global uint *)queue->aql_slot_mask;
+    __global AmdAqlWrap* disp = (__global AmdAqlWrap*)&wraps[idx];
+    uint slotState = atomic_load_explicit((__global atomic_uint*)(&disp->state), memory_order_acquire, memory_scope_device);
+    __global AmdAqlWrap* parent = (__global AmdAqlWrap*)(disp->parent_wrap);
+    __global AmdEvent* event = (__global AmdEvent*)(disp->completion);
+    int launch = 0;
+
+    *live = true;
+
+    // Check if the current slot is ready for processing
+    if (slotState == AQL_WRAP_READY) {
+        // Attempt to find a new dispatch
+        uint parentState = atomic_load_explicit((__global atomic_uint*)(&parent->state), memory_order_relaxed, memory_scope_device);
+        uint enqueueFlags = atomic_load_explicit( (__global atomic_uint*)(&disp->enqueue_flags), memory_order_relaxed, memory_scope_device);
+
+        // Check the launch flags
+        if (((enqueueFlags == CLK_ENQUEUE_FLAGS_WAIT_KERNEL) ||
+            (enqueueFlags == CLK_ENQUEUE_FLAGS_WAIT_WORK_GROUP)) &&
+            (parentState != AQL_WRAP_DONE)) {
+            return 0;
+        }
+
+        // Check if the wait list is COMPLETE
+        launch = advanceWaitEvents(disp, (__global uint*)queue->event_slot_mask, (__global AmdEvent*)queue->event_slots);
+
+        if (launch != 0) {
+            if (event != 0) {
+                event->timer[PROFILING_COMMAND_START] = ((ulong)__builtin_readcyclecounter() * (ulong)param->eng_clk) >> 10;
+            }
+            if (launch > 0) {
+                profileRecord(param, disp->command_id, PROFILE_QUEUED, disp->queued_time);
+                profileRecord(param, disp->command_id, PROFILE_START, __ockl_memrealtime_u64());
+                // Launch child kernel ....
+                launchDispatch(param, ctx, &disp->aql);
+            } else if (event != 0) {
+                event->state = -1;
+            }
+            atomic_store_explicit((__global atomic_uint*)&disp->state, AQL_WRAP_BUSY, memory_order_relaxed, memory_scope_device);
+            releasePendingEvents(disp, (__global uint*)queue->event_slot_mask, (__global AmdEvent*)queue->event_slots);
+        }
+    } else if (slotState == AQL_WRAP_MARKER) {
+        bool complete = false;
+        if (disp->wait_num == 0) {
+            uint minCommand = min_command(queue->aql_slot_num, wraps);
+            complete = disp->command_id == minCommand;
+        } else {
+            int status = advanceWaitEvents(disp, (__global uint*)queue->event_slot_mask, (__global AmdEvent*)queue->event_slots);
+            // Check if the wait list is COMPLETE
+            if (status != 0) {
+                complete = true;
+                releasePendingEvents(disp, (__global uint*)queue->event_slot_mask, (__global AmdEvent*)queue->event_slots);
+                if (status < 0)
+                    event->state = -1;
+            }
+        }
+        if (complete) {
+            // Decrement the child execution counter on the parent
+            atomic_fetch_sub_explicit((__global atomic_uint*)&parent->child_counter, 1, memory_order_relaxed, memory_scope_device);
+            if (event->state >= 0)
+                event->state = CL_COMPLETE;
+            atomic_store_explicit((__global atomic_uint*)&disp->state, AQL_WRAP_FREE, memory_order_relaxed, memory_scope_device);
+            *live = false;
+            release_slot(amask, idx);
+            releaseEvent(event, (__global uint*)queue->event_slot_mask, (__global AmdEvent*)queue->event_slots);
+        }
+    } else if ((slotState == AQL_WRAP_BUSY) || (slotState == AQL_WRAP_DONE)) {
+        if (slotState == AQL_WRAP_BUSY) {
+            atomic_store_explicit((__global atomic_uint*)&disp->state, AQL_WRAP_DONE, memory_order_relaxed, memory_scope_device);
+            profileRecord(param, disp->command_id, PROFILE_END, __ockl_memrealtime_u64());
+            if (event != 0) {
+                event->timer[PROFILING_COMMAND_END] = ((ulong)__builtin_readcyclecounter() * (ulong)param->eng_clk) >> 10;
+            }
+        }
+        // Was CL_EVENT requested?
+        if (event != 0) {
+            // The current dispatch doesn't have any outstanding children
+            if (disp->child_counter == 0) {
+                event->timer[PROFILING_COMMAND_COMPLETE] = ((ulong)__builtin_readcyclecounter() * (ulong)param->eng_clk) >> 10;
+                if (event->state >= 0) {
+                    event->state = CL_COMPLETE;
+                }
+                if (event->capture_info != 0) {
+                    __global ulong* values = (__global ulong*)event->capture_info;
+                    values[0] = event->timer[PROFILING_COMMAND_END] - event->timer[PROFILING_COMMAND_START];
+                    values[1] = event->timer[PROFILING_COMMAND_COMPLETE] - event->timer[PROFILING_COMMAND_START];
+                }
+                releaseEvent(event, (__global uint *)queue->event_slot_mask, (__global AmdEvent *)queue->event_slots);
+            }
+        }
+        // The current dispatch doesn't have any outstanding children
+        if (disp->child_counter == 0) {
+            profileRecord(param, disp->command_id, PROFILE_COMPLETE, __ockl_memrealtime_u64());
+            // Decrement the child execution counter on the parent
+            atomic_fetch_sub_explicit((__global atomic_uint*)&parent->child_counter, 1, memory_order_relaxed, memory_scope_device);
+            atomic_store_explicit((__global atomic_uint*)&disp->state, AQL_WRAP_FREE, memory_order_relaxed, memory_scope_device);
+            *live = false;
+            release_slot(amask, idx);
+        }
+    }
+
+    return launch;
+}
+
+// One scheduler pass of the calling thread, which launches at most one
+// dispatch.  Returns the result of schedule_slot for the last slot.
+static inline int
+schedule_pass(__global SchedulerParam* param, ulong ctx, __global AmdVQueueHeader* queue)
+{
+    __global AmdAqlWrap* wraps = (__global AmdAqlWrap*)&queue[1];
+    __global uint* amask = (__global uint *)queue->aql_slot_mask;
+
+    ulong readyList = VQUEUE_EXT(queue, ready_list);
+    int launch = 0;
+    bool live;
+
+    if (readyList != 0UL) {
+        // Only visit the slots listed before this pass started.  The ones
+        // pushed back here or by the other work-items of the pass are left
+        // to the next pass, a slot launched by one must not be retired by
+        // another before the kernel has run.
+        __global AmdReadyList* rl = (__global AmdReadyList*)readyList;
+        ulong end = ready_pass_begin(rl);
+
+        while (launch == 0) {
+            int idx = ready_pop(rl, end);
+            if (idx < 0)
+                break;
+
+            launch = schedule_slot(param, ctx, queue, wraps, (uint)idx, &live);
+            if (live)
+                ready_push(rl, (uint)idx);
+        }
+
+        ready_pass_end(rl, get_global_size(0));
+    } else {
+        int  grpId = get_group_id(0);
+        uint mskGrp = queue->mask_groups;
+
+        for (uint m = 0; m < mskGrp && launch == 0; ++m) {
+            uint maskId = grpId * mskGrp + m;
+            uint mask = atomic_load_explicit((__global atomic_uint*)(&amask[maskId]), memory_order_relaxed, memory_scope_device);
+
+            int baseIdx = maskId << 5;
+            while (mask != 0 && launch == 0) {
+                uint sIdx = ctz(mask);
+                uint idx = baseIdx + sIdx;
+                mask &= ~(1 << sIdx);
+                launch = schedule_slot(param, ctx, queue, wraps, idx, &live);
+            }
+        }
+    }
+
+    return launch;
+}
@@ -706,3 +706,49 @@ amd_fetch4_usi(read_only image2d_t im, sampler_t s, int2 coord, int comp)
     return as_uint4(amd_fetch4_isi(im, s, coord, comp));
 }
 
+
+FATTR float4
+amd_fetch4_2Da_fsf(read_only image2d_array_t im, sampler_t s, float4 coord, int comp)
+{
+    switch (comp) {
+    case 1:  return __ockl_image_gather4g_2Da(LOWER_ro_2Da(im), LOWER_sampler(s), coord);
+    case 2:  return __ockl_image_gather4b_2Da(LOWER_ro_2Da(im), LOWER_sampler(s), coord);
+    case 3:  return __ockl_image_gather4a_2Da(LOWER_ro_2Da(im), LOWER_sampler(s), coord);
+    default: return __ockl_image_gather4r_2Da(LOWER_ro_2Da(im), LOWER_sampler(s), coord);
+    }
+}
+
+FATTR float4
+amd_fetch4_2Da_ff(read_only image2d_array_t im, float4 coord, int comp)
+{
+    sampler_t s = CLK_NORMALIZED_COORDS_FALSE | CLK_FILTER_NEAREST | CLK_ADDRESS_NONE;
+    return amd_fetch4_2Da_fsf(im, s, coord, comp);
+}
+
+FATTR int4
+amd_fetch4_2Da_isf(read_only image2d_array_t im, sampler_t s, float4 coord, int comp)
+{
+    if (__oclc_ISA_version < 9000) {
+        coord.xy -= 0.5f;
+    }
+    return as_int4(amd_fetch4_2Da_fsf(im, s, coord, comp));
+}
+
+FATTR int4
+amd_fetch4_2Da_if(read_only image2d_array_t im, float4 coord, int comp)
+{
+    sampler_t s = CLK_NORMALIZED_COORDS_FALSE | CLK_FILTER_NEAREST | CLK_ADDRESS_NONE;
+    return amd_fetch4_2Da_isf(im, s, coord, comp);
+}
+
+FATTR uint4
+amd_fetch4_2Da_uf(read_only image2d_array_t im, float4 coord, int comp)
+{
+    return as_uint4(amd_fetch4_2Da_if(im, coord, comp));
+}
+
+FATTR uint4
+amd_fetch4_2Da_usf(read_only image2d_array_t im, sampler_t s, float4 coord, int comp)
+{
+    return as_uint4(amd_fetch4_2Da_isf(im, s, coord, comp));
+}
@@ -199,6 +199,95 @@ __amd_copyImageToBuffer(
     }
 }
 
+// Format specialized forms of the two blits above, one per component
+// count C and component size S.  T is the type the buffer is accessed
+// with, and the origins and pitches count pixels of C*S/sizeof(T) units.
+
+#define BLIT_FORMATS(F) \
+    F(1,1,uchar) \
+    F(1,2,ushort) \
+    F(1,4,uint) \
+    F(2,1,ushort) \
+    F(2,2,uint) \
+    F(2,4,uint) \
+    F(4,1,uint) \
+    F(4,2,uint) \
+    F(4,4,uint)
+
+#define unpack_1x1(P) (uint4)((uint)*(P), 0U, 0U, 0U)
+#define unpack_1x2(P) (uint4)((uint)*(P), 0U, 0U, 0U)
+#define unpack_1x4(P) (uint4)(*(P), 0U, 0U, 0U)
+#define unpack_2x1(P) (uint4)((uint)*(P) & 0xffU, (uint)*(P) >> 8, 0U, 0U)
+#define unpack_2x2(P) (uint4)(*(P) & 0xffffU, *(P) >> 16, 0U, 0U)
+#define unpack_2x4(P) (uint4)(vload2(0, P), 0U, 0U)
+#define unpack_4x1(P) convert_uint4(as_uchar4(*(P)))
+#define unpack_4x2(P) convert_uint4(as_ushort4(vload2(0, P)))
+#define unpack_4x4(P) vload4(0, P)
+
+#define pack_1x1(P,V) *(P) = (uchar)(V).x
+#define pack_1x2(P,V) *(P) = (ushort)(V).x
+#define pack_1x4(P,V) *(P) = (V).x
+#define pack_2x1(P,V) *(P) = (ushort)(V).x | ((ushort)(V).y << 8)
+#define pack_2x2(P,V) *(P) = (V).x | ((V).y << 16)
+#define pack_2x4(P,V) vstore2((V).xy, 0, P)
+#define pack_4x1(P,V) *(P) = as_uint(convert_uchar4(V))
+#define pack_4x2(P,V) vstore2(as_uint2(convert_ushort4(V)), 0, P)
+#define pack_4x4(P,V) vstore4(V, 0, P)
+
+#define GEN_COPY_BUFFER_IMAGE(C,S,T) \
+__attribute__((always_inline)) void \
+__amd_copyBufferToImage_##C##x##S( \
+    __global T* src, \
+    __write_only image2d_array_t dst, \
+    ulong4 srcOrigin, \
+    int4 dstOrigin, \
+    int4 size, \
+    ulong4 pitch) \
+{ \
+    int4 coordsDst = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0); \
+ \
+    if ((coordsDst.x >= size.x) || \
+        (coordsDst.y >= size.y) || \
+        (coordsDst.z >= size.z)) { \
+        return; \
+    } \
+ \
+    ulong idxSrc = (coordsDst.z * pitch.y + coordsDst.y * pitch.x + coordsDst.x) * \
+        (C * S / sizeof(T)) + srcOrigin.x; \
+ \
+    coordsDst += dstOrigin; \
+    coordsDst.w = 0; \
+    write_imageui(dst, coordsDst, unpack_##C##x##S(src + idxSrc)); \
+} \
+ \
+__attribute__((always_inline)) void \
+__amd_copyImageToBuffer_##C##x##S( \
+    __read_only image2d_array_t src, \
+    __global T* dst, \
+    int4 srcOrigin, \
+    ulong4 dstOrigin, \
+    int4 size, \
+    ulong4 pitch) \
+{ \
+    int4 coordsSrc = (int4)(get_global_id(0), get_global_id(1), get_global_id(2), 0); \
+ \
+    if ((coordsSrc.x >= size.x) || \
+        (coordsSrc.y >= size.y) || \
+        (coordsSrc.z >= size.z)) { \
+        return; \
+    } \
+ \
+    ulong idxDst = (coordsSrc.z * pitch.y + coordsSrc.y * pitch.x + coordsSrc.x) * \
+        (C * S / sizeof(T)) + dstOrigin.x; \
+ \
+    coordsSrc += srcOrigin; \
+    coordsSrc.w = 0; \
+    uint4 texel = read_imageui(src, coordsSrc); \
+    pack_##C##x##S(dst + idxDst, texel); \
+}
+
+BLIT_FORMATS(GEN_COPY_BUFFER_IMAGE)
+
 __attribute__((always_inline)) void
 __amd_copyImage(
     __read_only image2d_array_t src,
@@ -385,6 +474,103 @@ __amd_copyBufferAligned(
     }
 }
 
+#ifndef BLIT_UNROLL
+#define BLIT_UNROLL 4
+#endif
+
+// Grid stride loop over n elements, with BLIT_UNROLL loads in flight per
+// work-item before their stores
+#define GRID_STRIDE_COPY(T, N, LD, ST) \
+    do { \
+        ulong i_ = get_global_id(0); \
+        ulong g_ = get_global_size(0); \
+        for (; i_ + (BLIT_UNROLL-1)*g_ < (N); i_ += BLIT_UNROLL*g_) { \
+            T v_[BLIT_UNROLL]; \
+            _Pragma("unroll") \
+            for (uint u_ = 0; u_ < BLIT_UNROLL; ++u_) \
+                v_[u_] = LD(i_ + u_*g_); \
+            _Pragma("unroll") \
+            for (uint u_ = 0; u_ < BLIT_UNROLL; ++u_) \
+                ST(i_ + u_*g_, v_[u_]); \
+        } \
+        for (; i_ < (N); i_ += g_) \
+            ST(i_, LD(i_)); \
+    } while (0)
+
+// Copy of size bytes with any grid size.  The bytes before the first 16
+// byte aligned destination address and after the last whole 16 byte
+// chunk are moved a byte per work-item, the chunks in between as uint4.
+__attribute__((always_inline)) void
+__amd_copyBufferGS(
+    __global uchar* srcI,
+    __global uchar* dstI,
+    ulong srcOrigin,
+    ulong dstOrigin,
+    ulong size)
+{
+    ulong id = get_global_id(0);
+    __global uchar* src = srcI + srcOrigin;
+    __global uchar* dst = dstI + dstOrigin;
+
+    ulong head = min(size, (ulong)(-(ulong)dst & 15UL));
+    for (ulong j = id; j < head; j += get_global_size(0)) {
+        dst[j] = src[j];
+    }
+    src += head;
+    dst += head;
+    size -= head;
+
+    ulong chunks = size >> 4;
+    for (ulong j = id; j < (size & 15UL); j += get_global_size(0)) {
+        dst[(chunks << 4) + j] = src[(chunks << 4) + j];
+    }
+
+    __global uint4* dst4 = (__global uint4*)dst;
+#define ST4(I,V) dst4[I] = V
+    if (((ulong)src & 15UL) == 0) {
+        __global uint4* src4 = (__global uint4*)src;
+#define LD4(I) src4[I]
+        GRID_STRIDE_COPY(uint4, chunks, LD4, ST4);
+#undef LD4
+    }
+    else {
+#define LDU4(I) as_uint4(vload16(I, src))
+        GRID_STRIDE_COPY(uint4, chunks, LDU4, ST4);
+#undef LDU4
+    }
+#undef ST4
+}
+
+// Copy of size elements of alignment bytes, 4 or 16, with any grid size
+__attribute__((always_inline)) void
+__amd_copyBufferAlignedGS(
+    __global uint* src,
+    __global uint* dst,
+    ulong srcOrigin,
+    ulong dstOrigin,
+    ulong size,
+    uint alignment)
+{
+    if (alignment == 16) {
+        __global uint4* src4 = (__global uint4*)src + srcOrigin;
+        __global uint4* dst4 = (__global uint4*)dst + dstOrigin;
+#define LD4(I) src4[I]
+#define ST4(I,V) dst4[I] = V
+        GRID_STRIDE_COPY(uint4, size, LD4, ST4);
+#undef LD4
+#undef ST4
+    }
+    else {
+        __global uint* src1 = src + srcOrigin;
+        __global uint* dst1 = dst + dstOrigin;
+#define LD1(I) src1[I]
+#define ST1(I,V) dst1[I] = V
+        GRID_STRIDE_COPY(uint, size, LD1, ST1);
+#undef LD1
+#undef ST1
+    }
+}
+
 __attribute__((always_inline)) void
 __amd_fillBuffer(
     __global uchar* bufUChar,
@@ -417,6 +603,69 @@ __amd_fillBuffer(
     }
 }
 
+// The 16 bytes of a fill starting at byte k of the pattern
+static uint4
+fill_chunk(__constant uchar* pattern, uint patternSize, uint k)
+{
+    uint w[4] = { 0U, 0U, 0U, 0U };
+
+    for (uint b = 0; b < 16; ++b) {
+        w[b >> 2] |= (uint)pattern[k] << ((b & 3) * 8);
+        k = k + 1 == patternSize ? 0 : k + 1;
+    }
+
+    return (uint4)(w[0], w[1], w[2], w[3]);
+}
+
+// Fill of size pattern instances starting at byte offset, with any grid
+// size.  The bytes before the first 16 byte aligned address and after the
+// last whole 16 byte chunk are written a byte per work-item, the chunks
+// in between as uint4.  The chunks repeat every m of them, so with
+// a stride that is a multiple of m each work-item builds its 16 bytes
+// once and only stores in the loop.
+__attribute__((always_inline)) void
+__amd_fillBufferGS(
+    __global uchar* buf,
+    __constant uchar* pattern,
+    uint patternSize,
+    ulong offset,
+    ulong size)
+{
+    ulong id = get_global_id(0);
+    ulong g = get_global_size(0);
+    __global uchar* dst = buf + offset;
+    ulong bytes = size * patternSize;
+
+    ulong head = min(bytes, (ulong)(-(ulong)dst & 15UL));
+    for (ulong j = id; j < head; j += g) {
+        dst[j] = pattern[j % patternSize];
+    }
+
+    ulong chunks = (bytes - head) >> 4;
+    ulong tail = head + (chunks << 4);
+    for (ulong j = tail + id; j < bytes; j += g) {
+        dst[j] = pattern[j % patternSize];
+    }
+
+    uint m = patternSize / min(16U, patternSize & -patternSize);
+    __global uint4* dst4 = (__global uint4*)(dst + head);
+
+    if (g >= m) {
+        ulong stride = g - g % m;
+        if (id < stride) {
+            uint4 v = fill_chunk(pattern, patternSize, (uint)((head + (id << 4)) % patternSize));
+            for (ulong j = id; j < chunks; j += stride) {
+                dst4[j] = v;
+            }
+        }
+    }
+    else {
+        for (ulong j = id; j < chunks; j += g) {
+            dst4[j] = fill_chunk(pattern, patternSize, (uint)((head + (j << 4)) % patternSize));
+        }
+    }
+}
+
 __attribute__((always_inline)) void
 __amd_fillImage(
     __write_only image2d_array_t image,
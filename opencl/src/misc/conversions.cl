@@ -5,6 +5,9 @@
  * License. See LICENSE.TXT for details.
  *===------------------------------------------------------------------------*/
 
+#include "irif.h"
+#include "oclc.h"
+
 #pragma OPENCL EXTENSION cl_khr_fp16 : enable
 
 extern __attribute__((const)) uint __cvt_f16_rtn_f32(float);
@@ -218,12 +221,29 @@ convert_##TO##N##S##R(TI##N x) \
 #define PF2I(TO,TI,S,R) F2IE(_rtp,TO,TI,S,R)
 #define ZF2I(TO,TI,S,R) F2IE(_rtz,TO,TI,S,R)
 
+// Clamp one element with a single v_med3 where there is one.  Like
+// min(max()) this takes a quiet NaN to the lower bound.  v_med3_f16
+// first appears in gfx9.
+#define MED3_float(X,L,H) __builtin_amdgcn_fmed3f(X,L,H)
+#define MED3_half(X,L,H) (__oclc_ISA_version >= 9000 ? __llvm_amdgcn_fmed3_f16(X,L,H) : min(max(X,L),H))
+#define MED3_double(X,L,H) min(max(X,L),H)
+
+#define MED(TO,TI,E) C(MED3_,TI)(E, (TI) TO##_##TI##_lb, (TI) TO##_##TI##_ub)
+
+#define MLIST(TO,TI) MED(TO,TI,x)
+#define MLIST2(TO,TI) MED(TO,TI,x.s0), MED(TO,TI,x.s1)
+#define MLIST3(TO,TI) MLIST2(TO,TI), MED(TO,TI,x.s2)
+#define MLIST4(TO,TI) MLIST3(TO,TI), MED(TO,TI,x.s3)
+#define MLIST8(TO,TI) MLIST4(TO,TI), MED(TO,TI,x.s4), MED(TO,TI,x.s5), MED(TO,TI,x.s6), MED(TO,TI,x.s7)
+#define MLIST16(TO,TI) MLIST8(TO,TI), MED(TO,TI,x.s8), MED(TO,TI,x.s9), MED(TO,TI,x.sa), MED(TO,TI,x.sb), \
+                       MED(TO,TI,x.sc), MED(TO,TI,x.sd), MED(TO,TI,x.se), MED(TO,TI,x.sf)
+
 #define CLAMPFN(F,N,TO,TI,S,R) \
 ATTR TO##N \
 convert_##TO##N##S##R(TI##N x) \
 { \
-    x = min(max(F(x), (TI##N) TO##_##TI##_lb), (TI##N) TO##_##TI##_ub); \
-    return (TO##N)(XLIST##N); \
+    x = F(x); \
+    return (TO##N)(MLIST##N(TO,TI)); \
 }
 
 #define CLAMPF(F,TO,TI,S,R) \
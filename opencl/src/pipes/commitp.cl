@@ -15,7 +15,7 @@ __commit_read_pipe_##SIZE(__global struct pipeimp* p, size_t rid) \
 { \
 }
 
-// DO_PIPE_SIZE(COMMIT_READ_PIPE_SIZE)
+DO_PIPE_SIZE(COMMIT_READ_PIPE_SIZE)
 
 ATTR void
 __commit_read_pipe(__global struct pipeimp* p, size_t rid, uint size, uint align)
@@ -28,7 +28,7 @@ __commit_write_pipe_##SIZE(__global struct pipeimp* p, size_t rid) \
 { \
 }
 
-// DO_PIPE_SIZE(COMMIT_WRITE_PIPE_SIZE)
+DO_PIPE_SIZE(COMMIT_WRITE_PIPE_SIZE)
 
 ATTR void
 __commit_write_pipe(__global struct pipeimp* p, size_t rid, uint size, uint align)
@@ -43,7 +43,7 @@ __work_group_commit_read_pipe_##SIZE(__global struct pipeimp* p, size_t rid) \
 { \
 }
 
-// DO_PIPE_SIZE(WORK_GROUP_COMMIT_READ_PIPE_SIZE)
+DO_PIPE_SIZE(WORK_GROUP_COMMIT_READ_PIPE_SIZE)
 
 ATTR void
 __work_group_commit_read_pipe(__global struct pipeimp* p, size_t rid, uint size, uint align)
@@ -56,7 +56,7 @@ __work_group_commit_write_pipe_##SIZE(__global struct pipeimp* p, size_t rid) \
 { \
 }
 
-// DO_PIPE_SIZE(WORK_GROUP_COMMIT_WRITE_PIPE_SIZE)
+DO_PIPE_SIZE(WORK_GROUP_COMMIT_WRITE_PIPE_SIZE)
 
 ATTR void
 __work_group_commit_write_pipe(__global struct pipeimp* p, size_t rid, uint size, uint align)
@@ -71,7 +71,7 @@ __sub_group_commit_read_pipe_##SIZE(__global struct pipeimp* p, size_t rid) \
 { \
 }
 
-// DO_PIPE_SIZE(SUB_GROUP_COMMIT_READ_PIPE_SIZE)
+DO_PIPE_SIZE(SUB_GROUP_COMMIT_READ_PIPE_SIZE)
 
 ATTR void
 __sub_group_commit_read_pipe(__global struct pipeimp* p, size_t rid, uint size, uint align)
@@ -84,7 +84,7 @@ __sub_group_commit_write_pipe_##SIZE(__global struct pipeimp* p, size_t rid) \
 { \
 }
 
-// DO_PIPE_SIZE(SUB_GROUP_COMMIT_WRITE_PIPE_SIZE)
+DO_PIPE_SIZE(SUB_GROUP_COMMIT_WRITE_PIPE_SIZE)
 
 ATTR void
 __sub_group_commit_write_pipe(__global struct pipeimp* p, size_t rid, uint size, uint align)
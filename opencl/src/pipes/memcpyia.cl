@@ -5,8 +5,33 @@
  * License. See LICENSE.TXT for details.
  *===------------------------------------------------------------------------*/
 
-void
-__memcpy_internal_aligned(void *d, const void *s, size_t size, size_t align)
+#include "irif.h"
+#include "oclc.h"
+#include "ockl.h"
+
+// XXX from llvm/include/llvm/IR/InstrTypes.h
+#define ICMP_NE 33
+
+// Copies at least this large are shared by the active lanes of the wave,
+// as long as no more than WAVE_COPY_LANES lanes have one.  With more big
+// copies every lane is already busy and the copies are made per lane.
+#define WAVE_COPY_MIN 1024
+#define WAVE_COPY_LANES 4
+
+// Hack to prevent incorrect hoisting of the operation. There
+// currently is no proper way in llvm to prevent hoisting of
+// operations control flow dependent results.
+static int
+optimizationBarrierHack(int in_val)
+{
+    int out_val;
+    __asm__ volatile ("; ockl ballot hoisting hack %0" :
+                      "=v"(out_val) : "0"(in_val));
+    return out_val;
+}
+
+static void
+memcpy_lane(void *d, const void *s, size_t size, size_t align)
 {
     if (align == 2) {
 	short *d2 = (short *)d;
@@ -53,3 +78,88 @@ __memcpy_internal_aligned(void *d, const void *s, size_t size, size_t align)
     }
 }
 
+// Copy of n bytes made by the w lanes, l is this lane's rank.  The byte
+// head brings d to 16 byte alignment, then the body moves dwordx4 when s
+// is also aligned, dwords when it is only 4 aligned, and the rest is
+// moved a byte per lane.
+static void
+memcpy_wave(uchar *d, const uchar *s, size_t n, uint l, uint w)
+{
+    size_t h = min(n, (size_t)(-(ulong)d & 15UL));
+    for (size_t i = l; i < h; i += w)
+        d[i] = s[i];
+    d += h;
+    s += h;
+    n -= h;
+
+    if (((ulong)s & 15UL) == 0) {
+        size_t nv = n / 16;
+        for (size_t i = l; i < nv; i += w)
+            ((uint4 *)d)[i] = ((const uint4 *)s)[i];
+        d += nv*16;
+        s += nv*16;
+        n -= nv*16;
+    } else if (((ulong)s & 3UL) == 0) {
+        size_t nv = n / 4;
+        for (size_t i = l; i < nv; i += w)
+            ((uint *)d)[i] = ((const uint *)s)[i];
+        d += nv*4;
+        s += nv*4;
+        n -= nv*4;
+    }
+
+    for (size_t i = l; i < n; i += w)
+        d[i] = s[i];
+}
+
+static ulong
+readlane_u64(ulong x, uint i)
+{
+    return ((ulong)__builtin_amdgcn_readlane((uint)(x >> 32), i) << 32) |
+            (ulong)__builtin_amdgcn_readlane((uint)x, i);
+}
+
+// A few large copies are made one at a time by every active lane of the
+// wave.  Private memory cannot be shared between lanes, so copies to or
+// from it are always made by the calling lane alone.
+void
+__memcpy_internal_aligned(void *d, const void *s, size_t size, size_t align)
+{
+    bool big = size >= WAVE_COPY_MIN &&
+               !__ockl_is_private_addr(d) && !__ockl_is_private_addr(s);
+
+    int b = optimizationBarrierHack((int)big);
+    ulong m = __oclc_wavefrontsize64 ?
+        __llvm_amdgcn_icmp_i64_i32(b, 0, ICMP_NE) :
+        (ulong)__llvm_amdgcn_icmp_i32_i32(b, 0, ICMP_NE);
+
+    if (__builtin_popcountl(m) > WAVE_COPY_LANES) {
+        m = 0UL;
+        big = false;
+    }
+
+    if (m) {
+        ulong e = __builtin_amdgcn_read_exec();
+        uint w = (uint)__builtin_popcountl(e);
+        uint l = __builtin_amdgcn_mbcnt_hi((uint)(e >> 32),
+                   __builtin_amdgcn_mbcnt_lo((uint)e, 0u));
+
+        while (m) {
+            uint j = (uint)__builtin_ctzl(m);
+            uchar *dj = (uchar *)readlane_u64((ulong)d, j);
+            const uchar *sj = (const uchar *)readlane_u64((ulong)s, j);
+            size_t nj = readlane_u64((ulong)size, j);
+            memcpy_wave(dj, sj, nj, l, w);
+            m &= m - 1UL;
+        }
+
+        // Make the other lanes' stores visible to the owning lane
+        atomic_work_item_fence(CLK_GLOBAL_MEM_FENCE | CLK_LOCAL_MEM_FENCE,
+                               memory_order_acq_rel, memory_scope_sub_group);
+        __builtin_amdgcn_wave_barrier();
+    }
+
+    if (!big)
+        memcpy_lane(d, s, size, align);
+}
+
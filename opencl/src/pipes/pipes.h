@@ -9,6 +9,7 @@
 
 #pragma OPENCL EXTENSION cl_khr_int64_base_atomics : enable
 #pragma OPENCL EXTENSION cl_khr_int64_extended_atomics : enable
+#pragma OPENCL EXTENSION cl_khr_subgroups : enable
 
 extern size_t __amd_wresvn(volatile __global atomic_size_t *pidx, size_t lim, size_t n);
 
@@ -26,16 +27,83 @@ struct pipeimp {
     atomic_size_t read_idx;
     atomic_size_t write_idx;
     size_t end_idx;
-    uchar pad[128 - 3*sizeof(size_t)];
+    uint magic;
+    uint flags;
+    uchar pad[128 - 3*sizeof(size_t) - 2*sizeof(uint)];
     uchar packets[1];
 };
 
+// The pipe is a bounded MPMC ring.  Each of the end_idx slots has a
+// sequence number, stored as an array of size_t following the packets.
+// A slot may be written at position i when its sequence is 2i and read
+// when it is 2i+1; reading hands it on to position i+end_idx.  Counting
+// two per position keeps a full slot apart from a free one even when
+// end_idx is 1.  The indices only ever grow, and there is no reset.
+// Sequences are kept biased by twice the slot index so that a zero
+// filled pipe is a valid empty pipe.  The mode is opt in: the runtime has to
+// set magic to PIPE_MAGIC as well as the flag, so a header whose pad
+// was never cleared stays a default pipe.
+#define PIPE_MAGIC 0x434d504dU
+#define PIPE_FLAG_MPMC 0x1U
+
 extern void __memcpy_internal_aligned(void *, const void *, size_t, size_t);
 
+// Blocking forms of __read_pipe_2 and __write_pipe_2 for persistent
+// producer/consumer kernels.  They retry as a wave, sleeping between
+// rounds with a backoff doubling up to max_sleep units of s_sleep(1),
+// and always return 0.  There is no timeout: on a pipe that is never
+// written (read) or never drained (write) they spin forever.
+#define PIPE_BLOCKING_DECL(SIZE, STYPE) \
+extern int __read_pipe_2_blocking_##SIZE(__global struct pipeimp *p, STYPE *ptr, uint max_sleep); \
+extern int __write_pipe_2_blocking_##SIZE(__global struct pipeimp *p, const STYPE *ptr, uint max_sleep);
+
+DO_PIPE_SIZE(PIPE_BLOCKING_DECL)
+
+extern int __read_pipe_2_blocking(__global struct pipeimp *p, void *ptr, uint size, uint align, uint max_sleep);
+extern int __write_pipe_2_blocking(__global struct pipeimp *p, const void *ptr, uint size, uint align, uint max_sleep);
+
+#define PIPE_COPY_SIZE(SIZE, STYPE) \
+    case SIZE: \
+        *(STYPE *)d = *(const STYPE *)s; \
+        return;
+
+// Packets of a natural scalar or vector size are moved with a single
+// load and store; the switch folds away when size is a constant
+static __attribute__((always_inline)) void
+pipe_copy(void *d, const void *s, uint size, uint align)
+{
+    if (size == align) {
+        switch (size) {
+        DO_PIPE_SIZE(PIPE_COPY_SIZE)
+        default:
+            break;
+        }
+    }
+
+    __memcpy_internal_aligned(d, s, size, align);
+}
+
+#define PIPE_CAS_SLEEP_MAX 8U
+
+// Back off for b units of s_sleep(1), about 64 clocks each, and return
+// the next backoff, doubled and capped at lim.  A lim of 0 never sleeps.
+// The reservation loops below use it with PIPE_CAS_SLEEP_MAX after each
+// failed CAS, so a contended index is not hammered; the first retry is
+// immediate.
+static inline uint
+pipe_backoff(uint b, uint lim)
+{
+    for (uint k = 0; k < b; ++k)
+        __builtin_amdgcn_s_sleep(1);
+
+    return min(b ? b*2U : 1U, lim);
+}
+
 static __attribute__((always_inline)) size_t
 reserve(volatile __global atomic_size_t *pi, size_t lim, size_t n)
 {
     size_t i = __opencl_atomic_load(pi, memory_order_relaxed, memory_scope_device);
+    uint b = 0;
 
     for (;;) {
         if (i + n > lim)
@@ -43,6 +111,8 @@ reserve(volatile __global atomic_size_t *pi, size_t lim, size_t n)
 
         if (__opencl_atomic_compare_exchange_strong(pi, &i, i + n, memory_order_relaxed, memory_order_relaxed, memory_scope_device))
             break;
+
+        b = pipe_backoff(b, PIPE_CAS_SLEEP_MAX);
     }
 
     return i;
@@ -57,6 +127,7 @@ wave_reserve_1(volatile __global atomic_size_t *pi, size_t lim)
     size_t i = 0;
 
     if (l == 0) {
+        uint b = 0;
         i = __opencl_atomic_load(pi, memory_order_relaxed, memory_scope_device);
 
         for (;;) {
@@ -67,6 +138,8 @@ wave_reserve_1(volatile __global atomic_size_t *pi, size_t lim)
 
             if (__opencl_atomic_compare_exchange_strong(pi, &i, i + n, memory_order_relaxed, memory_order_relaxed, memory_scope_device))
                 break;
+
+            b = pipe_backoff(b, PIPE_CAS_SLEEP_MAX);
         }
     }
 
@@ -106,3 +179,163 @@ wrap(size_t i, size_t n)
     return ret;
 }
 
+static inline bool
+is_mpmc(__global struct pipeimp *p)
+{
+    return p->magic == PIPE_MAGIC && (p->flags & PIPE_FLAG_MPMC) != 0U;
+}
+
+static inline __global atomic_size_t *
+mpmc_seq(__global struct pipeimp *p, size_t size)
+{
+    size_t o = (p->end_idx * size + sizeof(size_t) - 1) & ~(sizeof(size_t) - 1);
+    return (__global atomic_size_t *)(p->packets + o);
+}
+
+// Distance of the slot of position i from the sequence of a writer,
+// r == 0, or a reader, r == 1
+static inline long
+mpmc_diff(__global atomic_size_t *seq, size_t i, size_t e, size_t r)
+{
+    size_t s = wrap(i, e);
+    size_t v = __opencl_atomic_load(seq + s, memory_order_acquire, memory_scope_device) + 2*s;
+    return (long)(v - (2*i + r));
+}
+
+// Publish a written slot for readers, r == 0, or hand a read slot back to
+// writers, r == 1
+static inline void
+mpmc_release(__global atomic_size_t *seq, size_t i, size_t e, size_t r)
+{
+    size_t s = wrap(i, e);
+    size_t v = r ? 2*(i + e) : 2*i + 1;
+    __opencl_atomic_store(seq + s, v - 2*s, memory_order_release, memory_scope_device);
+}
+
+// Claim n consecutive positions for writing, r == 0, or reading, r == 1
+static inline size_t
+mpmc_reserve(volatile __global atomic_size_t *pi, __global atomic_size_t *seq, size_t e, size_t n, size_t r)
+{
+    if (n > e)
+        return ~(size_t)0;
+
+    size_t i = __opencl_atomic_load(pi, memory_order_relaxed, memory_scope_device);
+    uint b = 0;
+
+    for (;;) {
+        long d = 0;
+        for (size_t k = 0; k < n && d == 0; ++k)
+            d = mpmc_diff(seq, i + k, e, r);
+
+        if (d < 0)
+            return ~(size_t)0;
+
+        if (d == 0) {
+            if (__opencl_atomic_compare_exchange_strong(pi, &i, i + n, memory_order_relaxed, memory_order_relaxed, memory_scope_device))
+                break;
+        } else
+            i = __opencl_atomic_load(pi, memory_order_relaxed, memory_scope_device);
+
+        b = pipe_backoff(b, PIPE_CAS_SLEEP_MAX);
+    }
+
+    return i;
+}
+
+// Claim one position per active lane.  Every lane checks its own slot so
+// that a whole wave is granted with a single CAS.
+static inline size_t
+mpmc_wave_reserve_1(volatile __global atomic_size_t *pi, __global atomic_size_t *seq, size_t e, size_t r)
+{
+    ulong n = __builtin_popcountl(__builtin_amdgcn_read_exec());
+    uint l = __builtin_amdgcn_mbcnt_hi(__builtin_amdgcn_read_exec_hi(),
+               __builtin_amdgcn_mbcnt_lo(__builtin_amdgcn_read_exec_lo(), 0u));
+    uint k = (uint)__llvm_cttz_i64(__builtin_amdgcn_read_exec());
+
+    if (n <= e) {
+        uint b = 0;
+        for (;;) {
+            size_t i = 0;
+            if (l == 0)
+                i = __opencl_atomic_load(pi, memory_order_relaxed, memory_scope_device);
+            i = ((size_t)__builtin_amdgcn_readlane((uint)(i >> 32), k) << 32) |
+                (size_t)__builtin_amdgcn_readlane((uint)i, k);
+
+            long d = mpmc_diff(seq, i + l, e, r);
+            if (sub_group_any(d < 0))
+                break;
+
+            if (sub_group_all(d == 0)) {
+                int ok = 0;
+                if (l == 0) {
+                    size_t j = i;
+                    ok = __opencl_atomic_compare_exchange_strong(pi, &j, i + n, memory_order_relaxed, memory_order_relaxed, memory_scope_device);
+                }
+                if (__builtin_amdgcn_readlane(ok, k))
+                    return i + l;
+            }
+
+            b = pipe_backoff(b, PIPE_CAS_SLEEP_MAX);
+        }
+    }
+
+    // The entire group didn't fit, have to handle one by one
+    return mpmc_reserve(pi, seq, e, (size_t)1, r);
+}
+
+// Claim n positions for each active lane, n may differ between lanes.
+// The requests of the wave are laid out in lane order and granted with a
+// single CAS, each lane checking the slots of its own request.
+static inline size_t
+mpmc_wave_reserve_n(volatile __global atomic_size_t *pi, __global atomic_size_t *seq, size_t e, size_t n, size_t r)
+{
+    uint l = __builtin_amdgcn_mbcnt_hi(__builtin_amdgcn_read_exec_hi(),
+               __builtin_amdgcn_mbcnt_lo(__builtin_amdgcn_read_exec_lo(), 0u));
+    uint k = (uint)__llvm_cttz_i64(__builtin_amdgcn_read_exec());
+
+    // Exclusive prefix of the requests over the active lanes
+    size_t o = 0;
+    size_t t = 0;
+    uint me = __builtin_amdgcn_mbcnt_hi(-1, __builtin_amdgcn_mbcnt_lo(-1, 0u));
+    ulong m = __builtin_amdgcn_read_exec();
+    while (m) {
+        uint j = (uint)__llvm_cttz_i64(m);
+        o = me == j ? t : o;
+        t += ((size_t)__builtin_amdgcn_readlane((uint)(n >> 32), j) << 32) |
+             (size_t)__builtin_amdgcn_readlane((uint)n, j);
+        m &= m - 1UL;
+    }
+
+    if (t <= e) {
+        uint b = 0;
+        for (;;) {
+            size_t i = 0;
+            if (l == 0)
+                i = __opencl_atomic_load(pi, memory_order_relaxed, memory_scope_device);
+            i = ((size_t)__builtin_amdgcn_readlane((uint)(i >> 32), k) << 32) |
+                (size_t)__builtin_amdgcn_readlane((uint)i, k);
+
+            long d = 0;
+            for (size_t c = 0; c < n && d == 0; ++c)
+                d = mpmc_diff(seq, i + o + c, e, r);
+
+            if (sub_group_any(d < 0))
+                break;
+
+            if (sub_group_all(d == 0)) {
+                int ok = 0;
+                if (l == 0) {
+                    size_t j = i;
+                    ok = __opencl_atomic_compare_exchange_strong(pi, &j, i + t, memory_order_relaxed, memory_order_relaxed, memory_scope_device);
+                }
+                if (__builtin_amdgcn_readlane(ok, k))
+                    return i + o;
+            }
+
+            b = pipe_backoff(b, PIPE_CAS_SLEEP_MAX);
+        }
+    }
+
+    // The entire group didn't fit, have to handle one by one
+    return mpmc_reserve(pi, seq, e, n, r);
+}
@@ -13,6 +13,18 @@
 ATTR int \
 __read_pipe_2_##SIZE(__global struct pipeimp* p, STYPE* ptr) \
 { \
+    if (is_mpmc(p)) { \
+        size_t ei = p->end_idx; \
+        __global atomic_size_t *seq = mpmc_seq(p, SIZE); \
+        size_t ri = mpmc_wave_reserve_1(&p->read_idx, seq, ei, 1); \
+        if (ri == ~(size_t)0) \
+            return -1; \
+ \
+        *ptr = ((__global STYPE *)p->packets)[wrap(ri, ei)]; \
+        mpmc_release(seq, ri, ei, 1); \
+        return 0; \
+    } \
+ \
     size_t wi = __opencl_atomic_load(&p->write_idx, memory_order_relaxed, memory_scope_device); \
     size_t ri = wave_reserve_1(&p->read_idx, wi); \
     if (ri == ~(size_t)0) \
@@ -34,13 +46,25 @@ DO_PIPE_SIZE(READ_PIPE_SIZE)
 ATTR int
 __read_pipe_2(__global struct pipeimp* p, void* ptr, uint size, uint align)
 {
+    if (is_mpmc(p)) {
+        size_t ei = p->end_idx;
+        __global atomic_size_t *seq = mpmc_seq(p, size);
+        size_t ri = mpmc_wave_reserve_1(&p->read_idx, seq, ei, 1);
+        if (ri == ~(size_t)0)
+            return -1;
+
+        pipe_copy(ptr, p->packets + wrap(ri, ei)*size, size, align);
+        mpmc_release(seq, ri, ei, 1);
+        return 0;
+    }
+
     size_t wi = __opencl_atomic_load(&p->write_idx, memory_order_relaxed, memory_scope_device);
     size_t ri = wave_reserve_1(&p->read_idx, wi);
     if (ri == ~(size_t)0)
         return -1;
 
     size_t pi = wrap(ri, p->end_idx);
-    __memcpy_internal_aligned(ptr, p->packets + pi*size, size, align);
+    pipe_copy(ptr, p->packets + pi*size, size, align);
 
     if (ri == wi-1) {
         __opencl_atomic_store(&p->write_idx, 0, memory_order_relaxed, memory_scope_device);
@@ -57,6 +81,9 @@ __read_pipe_4_##SIZE(__global struct pipeimp* p, reserve_id_t rid, uint i, STYPE
     size_t rin = __builtin_astype(rid, size_t) + i; \
     size_t pi = wrap(rin, p->end_idx); \
     *ptr = ((__global STYPE *)p->packets)[pi]; \
+ \
+    if (is_mpmc(p)) \
+        mpmc_release(mpmc_seq(p, SIZE), rin, p->end_idx, 1); \
  \
     return 0; \
 }
@@ -68,8 +95,57 @@ __read_pipe_4(__global struct pipeimp* p, reserve_id_t rid, uint i, void *ptr, u
 {
     size_t rin = __builtin_astype(rid, size_t) + i; \
     size_t pi = wrap(rin, p->end_idx);
-    __memcpy_internal_aligned(ptr, p->packets + pi*size, size, align);
+    pipe_copy(ptr, p->packets + pi*size, size, align);
+
+    if (is_mpmc(p))
+        mpmc_release(mpmc_seq(p, size), rin, p->end_idx, 1);
 
     return 0;
 }
 
+// Blocking variants, retried until the packet is read, sleeping between
+// rounds with a backoff growing up to max_sleep.  Lanes which succeed
+// wait for the rest of the wave so that every round is wave uniform
+// and the wave shares one reservation per round.  These never return
+// if nothing writes to the pipe.
+
+#define READ_PIPE_BLOCKING_SIZE(SIZE, STYPE) \
+ATTR int \
+__read_pipe_2_blocking_##SIZE(__global struct pipeimp* p, STYPE* ptr, uint max_sleep) \
+{ \
+    bool pending = true; \
+    uint b = 0; \
+ \
+    for (;;) { \
+        if (pending) \
+            pending = __read_pipe_2_##SIZE(p, ptr) != 0; \
+ \
+        if (!sub_group_any(pending)) \
+            break; \
+ \
+        b = pipe_backoff(b, max_sleep); \
+    } \
+ \
+    return 0; \
+}
+
+DO_PIPE_SIZE(READ_PIPE_BLOCKING_SIZE)
+
+ATTR int
+__read_pipe_2_blocking(__global struct pipeimp* p, void* ptr, uint size, uint align, uint max_sleep)
+{
+    bool pending = true;
+    uint b = 0;
+
+    for (;;) {
+        if (pending)
+            pending = __read_pipe_2(p, ptr, size, align) != 0;
+
+        if (!sub_group_any(pending))
+            break;
+
+        b = pipe_backoff(b, max_sleep);
+    }
+
+    return 0;
+}
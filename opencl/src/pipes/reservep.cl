@@ -15,6 +15,9 @@
 ATTR reserve_id_t \
 __reserve_read_pipe_##SIZE(__global struct pipeimp *p, uint num_packets) \
 { \
+    if (is_mpmc(p)) \
+        return __builtin_astype(mpmc_wave_reserve_n(&p->read_idx, mpmc_seq(p, SIZE), p->end_idx, num_packets, 1), reserve_id_t); \
+ \
     size_t wi = __opencl_atomic_load(&p->write_idx, memory_order_relaxed, memory_scope_device); \
     size_t rid = __amd_wresvn(&p->read_idx, wi, num_packets); \
  \
@@ -26,11 +29,14 @@ __reserve_read_pipe_##SIZE(__global struct pipeimp *p, uint num_packets) \
     return __builtin_astype(rid, reserve_id_t); \
 }
 
-// DO_PIPE_SIZE(RESERVE_READ_PIPE_SIZE)
+DO_PIPE_SIZE(RESERVE_READ_PIPE_SIZE)
 
 ATTR reserve_id_t
 __reserve_read_pipe(__global struct pipeimp *p, uint num_packets, uint size, uint align)
 {
+    if (is_mpmc(p))
+        return __builtin_astype(mpmc_wave_reserve_n(&p->read_idx, mpmc_seq(p, size), p->end_idx, num_packets, 1), reserve_id_t);
+
     size_t wi = __opencl_atomic_load(&p->write_idx, memory_order_relaxed, memory_scope_device);
     size_t rid = __amd_wresvn(&p->read_idx, wi, num_packets);
 
@@ -46,16 +52,23 @@ __reserve_read_pipe(__global struct pipeimp *p, uint num_packets, uint size, uin
 ATTR reserve_id_t \
 __reserve_write_pipe_##SIZE(__global struct pipeimp *p, uint num_packets) \
 { \
+    if (is_mpmc(p)) \
+        return __builtin_astype(mpmc_wave_reserve_n(&p->write_idx, mpmc_seq(p, SIZE), p->end_idx, num_packets, 0), reserve_id_t); \
+ \
     size_t ri = __opencl_atomic_load(&p->read_idx, memory_order_relaxed, memory_scope_device); \
     size_t ei = p->end_idx; \
-    return __amd_wresvn(&p->write_idx, ri + ei, num_packets); \
+    size_t rid = __amd_wresvn(&p->write_idx, ri + ei, num_packets); \
+    return __builtin_astype(rid, reserve_id_t); \
 }
 
-// DO_PIPE_SIZE(RESERVE_WRITE_PIPE_SIZE)
+DO_PIPE_SIZE(RESERVE_WRITE_PIPE_SIZE)
 
 ATTR reserve_id_t
 __reserve_write_pipe(__global struct pipeimp *p, uint num_packets, uint size, uint align)
 {
+    if (is_mpmc(p))
+        return __builtin_astype(mpmc_wave_reserve_n(&p->write_idx, mpmc_seq(p, size), p->end_idx, num_packets, 0), reserve_id_t);
+
     size_t ri = __opencl_atomic_load(&p->read_idx, memory_order_relaxed, memory_scope_device);
     size_t ei = p->end_idx;
     size_t rid = __amd_wresvn(&p->write_idx, ri + ei, num_packets);
@@ -72,9 +85,10 @@ __work_group_reserve_read_pipe_##SIZE(__global struct pipeimp *p, uint num_packe
  \
     if ((int)get_local_linear_id() == 0) { \
         size_t wi = __opencl_atomic_load(&p->write_idx, memory_order_relaxed, memory_scope_device); \
-        size_t rid = reserve(&p->read_idx, wi, num_packets); \
+        size_t rid = is_mpmc(p) ? mpmc_reserve(&p->read_idx, mpmc_seq(p, SIZE), p->end_idx, num_packets, 1) : \
+                                  reserve(&p->read_idx, wi, num_packets); \
  \
-        if (rid + num_packets == wi) { \
+        if (!is_mpmc(p) && rid + num_packets == wi) { \
             __opencl_atomic_store(&p->write_idx, 0, memory_order_relaxed, memory_scope_device); \
             __opencl_atomic_store(&p->read_idx, 0, memory_order_relaxed, memory_scope_device); \
         } \
@@ -87,7 +101,7 @@ __work_group_reserve_read_pipe_##SIZE(__global struct pipeimp *p, uint num_packe
     return __builtin_astype(*t, reserve_id_t); \
 }
 
-// DO_PIPE_SIZE(WORK_GROUP_RESERVE_READ_PIPE_SIZE)
+DO_PIPE_SIZE(WORK_GROUP_RESERVE_READ_PIPE_SIZE)
 
 ATTR reserve_id_t
 __work_group_reserve_read_pipe(__global struct pipeimp *p, uint num_packets, uint size, uint align)
@@ -96,9 +110,10 @@ __work_group_reserve_read_pipe(__global struct pipeimp *p, uint num_packets, uin
 
     if ((int)get_local_linear_id() == 0) {
         size_t wi = __opencl_atomic_load(&p->write_idx, memory_order_relaxed, memory_scope_device);
-        size_t rid = reserve(&p->read_idx, wi, num_packets);
+        size_t rid = is_mpmc(p) ? mpmc_reserve(&p->read_idx, mpmc_seq(p, size), p->end_idx, num_packets, 1) :
+                                  reserve(&p->read_idx, wi, num_packets);
 
-        if (rid + num_packets == wi) {
+        if (!is_mpmc(p) && rid + num_packets == wi) {
             __opencl_atomic_store(&p->write_idx, 0, memory_order_relaxed, memory_scope_device);
             __opencl_atomic_store(&p->read_idx, 0, memory_order_relaxed, memory_scope_device);
         }
@@ -120,7 +135,8 @@ __work_group_reserve_write_pipe_##SIZE(__global struct pipeimp *p, uint num_pack
     if ((int)get_local_linear_id() == 0) { \
         size_t ri = __opencl_atomic_load(&p->read_idx, memory_order_relaxed, memory_scope_device); \
         size_t ei = p->end_idx; \
-        *t = reserve(&p->write_idx, ri + ei, num_packets); \
+        *t = is_mpmc(p) ? mpmc_reserve(&p->write_idx, mpmc_seq(p, SIZE), ei, num_packets, 0) : \
+                          reserve(&p->write_idx, ri + ei, num_packets); \
     } \
  \
     work_group_barrier(CLK_LOCAL_MEM_FENCE); \
@@ -128,7 +144,7 @@ __work_group_reserve_write_pipe_##SIZE(__global struct pipeimp *p, uint num_pack
     return __builtin_astype(*t, reserve_id_t); \
 }
 
-// DO_PIPE_SIZE(WORK_GROUP_RESERVE_WRITE_PIPE_SIZE)
+DO_PIPE_SIZE(WORK_GROUP_RESERVE_WRITE_PIPE_SIZE)
 
 ATTR reserve_id_t
 __work_group_reserve_write_pipe(__global struct pipeimp *p, uint num_packets, uint size, uint align)
@@ -138,7 +154,8 @@ __work_group_reserve_write_pipe(__global struct pipeimp *p, uint num_packets, ui
     if ((int)get_local_linear_id() == 0) {
         size_t ri = __opencl_atomic_load(&p->read_idx, memory_order_relaxed, memory_scope_device);
         size_t ei = p->end_idx;
-        *t = reserve(&p->write_idx, ri + ei, num_packets);
+        *t = is_mpmc(p) ? mpmc_reserve(&p->write_idx, mpmc_seq(p, size), ei, num_packets, 0) :
+                          reserve(&p->write_idx, ri + ei, num_packets);
     }
 
     work_group_barrier(CLK_LOCAL_MEM_FENCE);
@@ -156,9 +173,10 @@ __sub_group_reserve_read_pipe_##SIZE(__global struct pipeimp *p, uint num_packet
  \
     if (get_sub_group_local_id() == 0) { \
         size_t wi = __opencl_atomic_load(&p->write_idx, memory_order_relaxed, memory_scope_device); \
-        rid = reserve(&p->read_idx, wi, num_packets); \
+        rid = is_mpmc(p) ? mpmc_reserve(&p->read_idx, mpmc_seq(p, SIZE), p->end_idx, num_packets, 1) : \
+                           reserve(&p->read_idx, wi, num_packets); \
  \
-        if (rid + num_packets == wi) { \
+        if (!is_mpmc(p) && rid + num_packets == wi) { \
             __opencl_atomic_store(&p->write_idx, 0, memory_order_relaxed, memory_scope_device); \
             __opencl_atomic_store(&p->read_idx, 0, memory_order_relaxed, memory_scope_device); \
         } \
@@ -167,7 +185,7 @@ __sub_group_reserve_read_pipe_##SIZE(__global struct pipeimp *p, uint num_packet
     return __builtin_astype(sub_group_broadcast(rid, 0), reserve_id_t); \
 }
 
-// DO_PIPE_SIZE(SUB_GROUP_RESERVE_READ_PIPE_SIZE)
+DO_PIPE_SIZE(SUB_GROUP_RESERVE_READ_PIPE_SIZE)
 
 ATTR reserve_id_t
 __sub_group_reserve_read_pipe(__global struct pipeimp *p, uint num_packets, uint size, uint align)
@@ -176,9 +194,10 @@ __sub_group_reserve_read_pipe(__global struct pipeimp *p, uint num_packets, uint
 
     if (get_sub_group_local_id() == 0) {
         size_t wi = __opencl_atomic_load(&p->write_idx, memory_order_relaxed, memory_scope_device);
-        rid = reserve(&p->read_idx, wi, num_packets);
+        rid = is_mpmc(p) ? mpmc_reserve(&p->read_idx, mpmc_seq(p, size), p->end_idx, num_packets, 1) :
+                           reserve(&p->read_idx, wi, num_packets);
 
-        if (rid + num_packets == wi) {
+        if (!is_mpmc(p) && rid + num_packets == wi) {
             __opencl_atomic_store(&p->write_idx, 0, memory_order_relaxed, memory_scope_device);
             __opencl_atomic_store(&p->read_idx, 0, memory_order_relaxed, memory_scope_device);
         }
@@ -196,13 +215,14 @@ __sub_group_reserve_write_pipe_##SIZE(__global struct pipeimp *p, uint num_packe
     if (get_sub_group_local_id() == 0) { \
         size_t ri = __opencl_atomic_load(&p->read_idx, memory_order_relaxed, memory_scope_device); \
         size_t ei = p->end_idx; \
-        rid = reserve(&p->write_idx, ri + ei, num_packets); \
+        rid = is_mpmc(p) ? mpmc_reserve(&p->write_idx, mpmc_seq(p, SIZE), ei, num_packets, 0) : \
+                           reserve(&p->write_idx, ri + ei, num_packets); \
     } \
  \
     return __builtin_astype(sub_group_broadcast(rid, 0), reserve_id_t); \
 }
 
-// DO_PIPE_SIZE(SUB_GROUP_RESERVE_WRITE_PIPE_SIZE)
+DO_PIPE_SIZE(SUB_GROUP_RESERVE_WRITE_PIPE_SIZE)
 
 ATTR reserve_id_t
 __sub_group_reserve_write_pipe(__global struct pipeimp *p, uint num_packets, uint size, uint align)
@@ -212,7 +232,8 @@ __sub_group_reserve_write_pipe(__global struct pipeimp *p, uint num_packets, uin
     if (get_sub_group_local_id() == 0) {
         size_t ri = __opencl_atomic_load(&p->read_idx, memory_order_relaxed, memory_scope_device);
         size_t ei = p->end_idx;
-        rid = reserve(&p->write_idx, ri + ei, num_packets);
+        rid = is_mpmc(p) ? mpmc_reserve(&p->write_idx, mpmc_seq(p, size), ei, num_packets, 0) :
+                           reserve(&p->write_idx, ri + ei, num_packets);
     }
 
     return __builtin_astype(sub_group_broadcast(rid, 0), reserve_id_t);
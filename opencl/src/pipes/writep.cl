@@ -13,6 +13,18 @@
 ATTR int \
 __write_pipe_2_##SIZE(__global struct pipeimp* p, const STYPE* ptr) \
 { \
+    if (is_mpmc(p)) { \
+        size_t ei = p->end_idx; \
+        __global atomic_size_t *seq = mpmc_seq(p, SIZE); \
+        size_t wi = mpmc_wave_reserve_1(&p->write_idx, seq, ei, 0); \
+        if (wi == ~(size_t)0) \
+            return -1; \
+ \
+        ((__global STYPE *)p->packets)[wrap(wi, ei)] = *ptr; \
+        mpmc_release(seq, wi, ei, 0); \
+        return 0; \
+    } \
+ \
     size_t ri = atomic_load_explicit(&p->read_idx, memory_order_relaxed, memory_scope_device); \
     size_t ei = p->end_idx; \
     size_t wi = wave_reserve_1(&p->write_idx, ri+ei); \
@@ -29,6 +41,18 @@ DO_PIPE_SIZE(WRITE_PIPE_SIZE)
 ATTR int
 __write_pipe_2(__global struct pipeimp* p, const void* ptr, uint size, uint align)
 {
+    if (is_mpmc(p)) {
+        size_t ei = p->end_idx;
+        __global atomic_size_t *seq = mpmc_seq(p, size);
+        size_t wi = mpmc_wave_reserve_1(&p->write_idx, seq, ei, 0);
+        if (wi == ~(size_t)0)
+            return -1;
+
+        pipe_copy(p->packets + wrap(wi, ei)*size, ptr, size, align);
+        mpmc_release(seq, wi, ei, 0);
+        return 0;
+    }
+
     size_t ri = atomic_load_explicit(&p->read_idx, memory_order_relaxed, memory_scope_device);
     size_t ei = p->end_idx;
     size_t wi = wave_reserve_1(&p->write_idx, ri+ei);
@@ -36,7 +60,7 @@ __write_pipe_2(__global struct pipeimp* p, const void* ptr, uint size, uint alig
         return -1;
 
     size_t pi = wrap(wi, ei);
-    __memcpy_internal_aligned(p->packets + pi*size, ptr, size, align);
+    pipe_copy(p->packets + pi*size, ptr, size, align);
 
     return 0;
 }
@@ -48,6 +72,10 @@ __write_pipe_4_##SIZE(__global struct pipeimp* p, reserve_id_t rid, uint i, cons
     size_t rin = __builtin_astype(rid, size_t) + i; \
     size_t pi = wrap(rin, p->end_idx); \
     ((__global STYPE *)p->packets)[pi] = *ptr; \
+ \
+    if (is_mpmc(p)) \
+        mpmc_release(mpmc_seq(p, SIZE), rin, p->end_idx, 0); \
+ \
     return 0; \
 }
 
@@ -58,8 +86,57 @@ __write_pipe_4(__global struct pipeimp* p, reserve_id_t rid, uint i, const void
 {
     size_t rin = __builtin_astype(rid, size_t) + i; \
     size_t pi = wrap(rin, p->end_idx);
-    __memcpy_internal_aligned(p->packets + pi*size, ptr, size, align);
+    pipe_copy(p->packets + pi*size, ptr, size, align);
+
+    if (is_mpmc(p))
+        mpmc_release(mpmc_seq(p, size), rin, p->end_idx, 0);
 
     return 0;
 }
 
+// Blocking variants, retried until the packet is written, sleeping between
+// rounds with a backoff growing up to max_sleep.  Lanes which succeed
+// wait for the rest of the wave so that every round is wave uniform
+// and the wave shares one reservation per round.  These never return
+// if nothing reads from the pipe.
+
+#define WRITE_PIPE_BLOCKING_SIZE(SIZE, STYPE) \
+ATTR int \
+__write_pipe_2_blocking_##SIZE(__global struct pipeimp* p, const STYPE* ptr, uint max_sleep) \
+{ \
+    bool pending = true; \
+    uint b = 0; \
+ \
+    for (;;) { \
+        if (pending) \
+            pending = __write_pipe_2_##SIZE(p, ptr) != 0; \
+ \
+        if (!sub_group_any(pending)) \
+            break; \
+ \
+        b = pipe_backoff(b, max_sleep); \
+    } \
+ \
+    return 0; \
+}
+
+DO_PIPE_SIZE(WRITE_PIPE_BLOCKING_SIZE)
+
+ATTR int
+__write_pipe_2_blocking(__global struct pipeimp* p, const void* ptr, uint size, uint align, uint max_sleep)
+{
+    bool pending = true;
+    uint b = 0;
+
+    for (;;) {
+        if (pending)
+            pending = __write_pipe_2(p, ptr, size, align) != 0;
+
+        if (!sub_group_any(pending))
+            break;
+
+        b = pipe_backoff(b, max_sleep);
+    }
+
+    return 0;
+}
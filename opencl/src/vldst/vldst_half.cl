@@ -67,11 +67,62 @@ vloada_half(size_t i, const A half *p) \
 LAGENA(__constant)
 LAGENA()
 
+// Pairs of floats are truncated to halves by one v_cvt_pkrtz.  Overflow is
+// clamped to the largest finite half first so that truncation saturates.
+// Truncation is either exact or one ulp toward zero from the directed
+// result, so rtp and rtn add one to the magnitude where the conversion was
+// inexact and the sign is the one they round away from zero.
+static inline half2
+pk2_rtz(float2 v)
+{
+    int2 o = (fabs(v) > 65504.0f) & (fabs(v) < INFINITY);
+    v = select(v, copysign((float2)65504.0f, v), o);
+    return __builtin_amdgcn_cvt_pkrtz(v.s0, v.s1);
+}
+
+static inline half2
+pk2_rtp(float2 v)
+{
+    half2 h = pk2_rtz(v);
+    int2 b = (convert_float2(h) != v) & (v > 0.0f);
+    return as_half2(as_ushort2(h) - convert_ushort2(b));
+}
+
+static inline half2
+pk2_rtn(float2 v)
+{
+    half2 h = pk2_rtz(v);
+    int2 b = (convert_float2(h) != v) & (v < 0.0f);
+    return as_half2(as_ushort2(h) - convert_ushort2(b));
+}
+
+#define PKGENR(R) \
+static inline half4 pk4##R(float4 v) { return (half4)(pk2##R(v.s01), pk2##R(v.s23)); } \
+static inline half3 pk3##R(float3 v) { return pk4##R((float4)(v, 0.0f)).s012; } \
+static inline half8 pk8##R(float8 v) { return (half8)(pk4##R(v.lo), pk4##R(v.hi)); } \
+static inline half16 pk16##R(float16 v) { return (half16)(pk8##R(v.lo), pk8##R(v.hi)); }
+
+PKGENR(_rtz)
+PKGENR(_rtp)
+PKGENR(_rtn)
+
+// Conversion for a vector store, directed rounding of floats is packed
+#define CVT_float(N,V) convert_half##N(V)
+#define CVT_float_rte(N,V) convert_half##N##_rte(V)
+#define CVT_float_rtn(N,V) pk##N##_rtn(V)
+#define CVT_float_rtp(N,V) pk##N##_rtp(V)
+#define CVT_float_rtz(N,V) pk##N##_rtz(V)
+#define CVT_double(N,V) convert_half##N(V)
+#define CVT_double_rte(N,V) convert_half##N##_rte(V)
+#define CVT_double_rtn(N,V) convert_half##N##_rtn(V)
+#define CVT_double_rtp(N,V) convert_half##N##_rtp(V)
+#define CVT_double_rtz(N,V) convert_half##N##_rtz(V)
+
 #define SGENTARN(N,T,A,R) \
 SATTR void \
 vstore_half##N##R(T##N v, size_t i, A half *p) \
 { \
-    vstore##N(convert_half##N##R(v), i, p); \
+    vstore##N(CVT_##T##R(N,v), i, p); \
 }
 
 #define SGENTAR1(T,A,R) \
@@ -106,7 +157,7 @@ SGENT(double)
 SATTR void \
 vstorea_half##N##R(T##N v, size_t i, A half *p) \
 { \
-    *(A half##N *)(p + i*N) = convert_half##N##R(v); \
+    *(A half##N *)(p + i*N) = CVT_##T##R(N,v); \
 }
 
 #define SAGENTAR3(T,A,R) \
@@ -114,7 +165,7 @@ SATTR void \
 vstorea_half3##R(T##3 v, size_t i, A half *p) \
 { \
     half4 h; \
-    h.s012 = convert_half3##R(v); \
+    h.s012 = CVT_##T##R(3,v); \
     *(A half4 *)(p + i*4) = h; \
 }
 
@@ -0,0 +1,281 @@
+/*===--------------------------------------------------------------------------
+ *                   ROCm Device Libraries
+ *
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE.TXT for details.
+ *===------------------------------------------------------------------------*/
+
+// Decoder for the device enqueue profile ring of opencl/src/devenq/devenq.h.
+//
+//   devenq_profdecode <dump>
+//
+// reads a dump of an AmdProfileRing, its header followed by its size
+// records as they are in memory, takes the records from read_index on as
+// the host drains them, and prints for each child dispatch its QUEUED,
+// START, END and COMPLETE times and a summary of the time from enqueue to
+// launch, of the run and from the end of the kernel to completion, in the
+// units of __ockl_memrealtime_u64.
+//
+// Without arguments it tests itself: a tree of enqueues is run through the
+// scheduler model of sim.h with a ring the host drains after every pass,
+// then dumped and decoded again.  Every dispatch must have its four
+// records, each stamped with its position, in order and with times which
+// do not go backwards.  A ring left undrained must count what did not fit
+// as dropped.
+
+#include "sim.h"
+
+struct command {
+    ulong time[4];
+    uint seen;              // bit k for a record of kind k
+};
+
+struct decoded {
+    struct command *cmd;
+    uint ncmd;
+    ulong records;
+    ulong unstamped;        // records not written yet, which end a drain
+    ulong disorder;         // records of a kind seen twice or out of order
+};
+
+static struct command *
+command(struct decoded *d, uint id)
+{
+    if (id >= d->ncmd) {
+        uint n = max(id + 1U, d->ncmd * 2U);
+        d->cmd = realloc(d->cmd, n * sizeof(struct command));
+        memset(d->cmd + d->ncmd, 0, (n - d->ncmd) * sizeof(struct command));
+        d->ncmd = n;
+    }
+    return &d->cmd[id];
+}
+
+// Takes the records between read_index and write_index, as the host does,
+// up to the first one not stamped yet, and hands them back to the ring
+static void
+drain(AmdProfileRing *ring, struct decoded *d)
+{
+    ulong r = ring->read_index;
+    ulong w = __atomic_load_n(&ring->write_index, __ATOMIC_ACQUIRE);
+
+    for (; r < w; ++r) {
+        AmdProfileRecord *rec = &ring->records[r & (ulong)(ring->size - 1U)];
+        if (__atomic_load_n(&rec->stamp, __ATOMIC_ACQUIRE) != (uint)(r + 1UL)) {
+            ++d->unstamped;
+            break;
+        }
+
+        struct command *c = command(d, rec->command_id);
+        uint k = rec->kind;
+        ++d->records;
+        if (k > PROFILE_COMPLETE || (c->seen >> k) != 0U) {
+            ++d->disorder;
+            continue;
+        }
+        c->seen |= 1U << k;
+        c->time[k] = rec->time;
+    }
+
+    __atomic_store_n(&ring->read_index, r, __ATOMIC_RELEASE);
+}
+
+struct span {
+    ulong n, sum, max;
+};
+
+static void
+span_add(struct span *s, ulong a, ulong b)
+{
+    ulong t = b - a;
+    ++s->n;
+    s->sum += t;
+    s->max = max(s->max, t);
+}
+
+// Prints the commands, when verbose, and the summary.  Returns the
+// number of commands with a missing record or times out of order.
+static uint
+report(const struct decoded *d, ulong dropped, bool verbose)
+{
+    static const char *names[] = { "queue", "run", "complete" };
+    struct span s[3] = { { 0 } };
+    uint partial = 0, backwards = 0, commands = 0;
+
+    for (uint i = 0; i < d->ncmd; ++i) {
+        const struct command *c = &d->cmd[i];
+        if (c->seen == 0U)
+            continue;
+        ++commands;
+        if (verbose)
+            printf("command %6u: queued %12lu start %12lu end %12lu complete %12lu\n",
+                   i, c->time[0], c->time[1], c->time[2], c->time[3]);
+        if (c->seen != 0xfU) {
+            ++partial;
+            continue;
+        }
+        for (uint k = 0; k < 3; ++k) {
+            if (c->time[k + 1] < c->time[k])
+                ++backwards;
+            else
+                span_add(&s[k], c->time[k], c->time[k + 1]);
+        }
+    }
+
+    printf("%lu records, %u commands, %u partial, %u out of order, %lu misplaced, %lu dropped\n",
+           d->records, commands, partial, backwards, d->disorder, dropped);
+    for (uint k = 0; k < 3; ++k)
+        printf("  %-8s mean %10.2f max %10lu\n", names[k],
+               s[k].n ? (double)s[k].sum / (double)s[k].n : 0.0, s[k].max);
+    return partial + backwards + (uint)d->disorder;
+}
+
+static AmdProfileRing *
+load(const char *path)
+{
+    AmdProfileRing h, *ring = NULL;
+    FILE *f = fopen(path, "rb");
+
+    if (f && fread(&h, offsetof(AmdProfileRing, records), 1, f) == 1 &&
+        h.size != 0U && (h.size & (h.size - 1U)) == 0U) {
+        ring = malloc(sizeof(AmdProfileRing) + h.size * sizeof(AmdProfileRecord));
+        *ring = h;
+        if (fread(ring->records, sizeof(AmdProfileRecord), h.size, f) != h.size) {
+            free(ring);
+            ring = NULL;
+        }
+    }
+    if (f)
+        fclose(f);
+    return ring;
+}
+
+static bool
+dump(const AmdProfileRing *ring, const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    bool ok = f && fwrite(ring, offsetof(AmdProfileRing, records), 1, f) == 1 &&
+              fwrite(ring->records, sizeof(AmdProfileRecord), ring->size, f) == ring->size;
+    if (f)
+        fclose(f);
+    return ok;
+}
+
+// The self test: a fan-out 4 tree of the given number of nodes, each
+// launched node enqueueing its children
+#define FAN 4
+
+struct tree {
+    struct sim *s;
+    uint nodes;
+};
+
+struct kernel {
+    struct tree *t;
+    struct sim_launch l;
+};
+
+static void *
+kernel(void *arg)
+{
+    struct kernel *k = arg;
+    uint node = (uint)k->l.node;
+
+    for (uint c = 0; c < FAN; ++c) {
+        uint child = node * FAN + 1U + c;
+        if (child < k->t->nodes)
+            sim_enqueue(k->t->s, k->l.wrap, child, CLK_ENQUEUE_FLAGS_NO_WAIT, c);
+    }
+    return NULL;
+}
+
+static void
+run_tree(struct tree *t, struct decoded *d)
+{
+    struct kernel k[32];
+    pthread_t th[32];
+
+    sim_enqueue(t->s, &t->s->host_parent, 0, CLK_ENQUEUE_FLAGS_NO_WAIT, 0);
+    while (!sim_idle(t->s) && t->s->pass < 10000) {
+        uint n = sim_pass(t->s);
+        for (uint i = 0; i < n; ++i) {
+            k[i].t = t;
+            k[i].l = t->s->launched[i];
+            pthread_create(&th[i], NULL, kernel, &k[i]);
+        }
+        for (uint i = 0; i < n; ++i)
+            pthread_join(th[i], NULL);
+        if (d)
+            drain(t->s->ring, d);
+    }
+}
+
+static uint
+self_test(void)
+{
+    const char *path = "devenq_profdecode.ring";
+    uint bad = 0;
+
+    // Drained after every pass, which logs at most two records per slot:
+    // nothing may be lost
+    struct tree t = { .nodes = 341 };
+    struct decoded live = { 0 };
+    t.s = sim_new(1024, 1, SIM_READY_LIST | SIM_PROFILE_RING, 1024);
+    run_tree(&t, &live);
+    printf("drained after every pass, times in passes:\n");
+    bad += report(&live, t.s->ring->dropped, false);
+    bad += live.records != 4UL * t.nodes || t.s->ring->dropped != 0 || live.unstamped != 0;
+
+    // The dump of the drained ring has nothing left to read, rewound it
+    // must decode to the last size records again
+    t.s->ring->read_index = t.s->ring->write_index - t.s->ring->size;
+    bad += !dump(t.s->ring, path);
+    AmdProfileRing *ring = load(path);
+    struct decoded again = { 0 };
+    if (ring) {
+        drain(ring, &again);
+        bad += again.records != ring->size || again.unstamped != 0;
+        free(ring);
+    } else {
+        ++bad;
+    }
+    free(again.cmd);
+    free(live.cmd);
+    sim_free(t.s);
+
+    // Never drained: what does not fit is dropped, and the records kept
+    // are the first ones
+    struct decoded full = { 0 };
+    t.s = sim_new(1024, 1, SIM_READY_LIST | SIM_PROFILE_RING, 256);
+    run_tree(&t, NULL);
+    drain(t.s->ring, &full);
+    printf("never drained, ring of %u:\n", t.s->ring->size);
+    report(&full, t.s->ring->dropped, false);
+    bad += full.records != t.s->ring->size || full.disorder != 0 ||
+           full.records + t.s->ring->dropped != 4UL * t.nodes ||
+           !(full.cmd[0].seen & (1U << PROFILE_QUEUED));
+    free(full.cmd);
+    sim_free(t.s);
+
+    remove(path);
+    return bad;
+}
+
+int
+main(int argc, char **argv)
+{
+    if (argc < 2)
+        return self_test() != 0;
+
+    AmdProfileRing *ring = load(argv[1]);
+    if (!ring) {
+        fprintf(stderr, "%s: not a profile ring dump\n", argv[1]);
+        return 2;
+    }
+
+    struct decoded d = { 0 };
+    drain(ring, &d);
+    report(&d, ring->dropped, true);
+    free(d.cmd);
+    free(ring);
+    return 0;
+}
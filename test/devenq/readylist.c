@@ -0,0 +1,148 @@
+/*===--------------------------------------------------------------------------
+ *                   ROCm Device Libraries
+ *
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE.TXT for details.
+ *===------------------------------------------------------------------------*/
+
+// Checks the ready list of opencl/src/devenq: threads enqueue kernels as
+// __enqueue_kernel_basic does while scheduler passes run at the same time,
+// on queues small enough for the list to wrap and for enqueue to find the
+// queue full.  Every kernel must be launched exactly once, its wrap still
+// BUSY when the pass that launched it is over, and the queue left empty.  The same runs are made scanning aql_slot_mask, and with a
+// ready list the scheduler must not use: one behind a wrong ext_magic and
+// one the ext's size does not cover.
+
+#include "sim.h"
+
+#define ENQUEUERS 8
+
+struct stress {
+    struct sim *s;
+    uint per_thread;
+    uint *launches;
+    uint early;             // wraps moved on before their kernel ran
+    uint done;
+    ulong full;             // enqueues retried on a full queue
+};
+
+struct enqueuer {
+    struct stress *t;
+    uint id;
+};
+
+static void *
+enqueuer(void *arg)
+{
+    struct enqueuer *e = arg;
+    struct stress *t = e->t;
+    ulong full = 0;
+
+    for (uint i = 0; i < t->per_thread; ++i) {
+        uint node = e->id * t->per_thread + i;
+        uint flags = node & 1U ? CLK_ENQUEUE_FLAGS_WAIT_KERNEL : CLK_ENQUEUE_FLAGS_NO_WAIT;
+        while (sim_enqueue(t->s, &t->s->host_parent, node, flags, e->id * 64U + i % 64U) != 0) {
+            ++full;
+            sched_yield();
+        }
+    }
+
+    __atomic_fetch_add(&t->full, full, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&t->done, 1U, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static uint
+check(struct stress *t, const char *what)
+{
+    uint n = ENQUEUERS * t->per_thread;
+    uint bad = 0;
+
+    for (uint i = 0; i < n; ++i)
+        bad += t->launches[i] != 1U;
+    bad += t->early + !sim_idle(t->s);
+
+    printf("%4u slots, %-17s: %5u kernels in %5lu passes, %6lu full, %u early%s\n",
+           t->s->vq->aql_slot_num, what, n, t->s->pass, t->full, t->early, bad ? "  FAILED" : "");
+    return bad;
+}
+
+// Counts the launches of the last pass
+static void
+launched(struct stress *t, uint n)
+{
+    for (uint i = 0; i < n; ++i) {
+        struct sim_launch *l = &t->s->launched[i];
+        ++t->launches[l->node];
+        t->early += l->wrap->state != AQL_WRAP_BUSY;
+    }
+}
+
+static uint
+stress(uint slots, uint flags, uint per_thread)
+{
+    struct stress t = { .per_thread = per_thread };
+    struct enqueuer e[ENQUEUERS];
+    pthread_t th[ENQUEUERS];
+
+    t.s = sim_new(slots, 1, flags, 0);
+    t.launches = calloc(ENQUEUERS * per_thread, sizeof(uint));
+
+    for (uint i = 0; i < ENQUEUERS; ++i) {
+        e[i].t = &t;
+        e[i].id = i;
+        pthread_create(&th[i], NULL, enqueuer, &e[i]);
+    }
+
+    // The kernels launched have nothing to run, so a pass may follow at once
+    while (__atomic_load_n(&t.done, __ATOMIC_ACQUIRE) < ENQUEUERS || !sim_idle(t.s))
+        launched(&t, sim_pass(t.s));
+
+    for (uint i = 0; i < ENQUEUERS; ++i)
+        pthread_join(th[i], NULL);
+
+    uint bad = check(&t, flags & SIM_READY_LIST ? "ready, concurrent" : "mask, concurrent");
+    free(t.launches);
+    sim_free(t.s);
+    return bad;
+}
+
+// A queue with a ready list which is not to be used: enqueue must not push
+// to it and the scheduler must find the kernels by scanning the mask
+static uint
+fallback(bool magic)
+{
+    struct stress t = { .per_thread = 64 };
+    uint n = ENQUEUERS * t.per_thread;
+
+    t.s = sim_new(1024, 1, SIM_READY_LIST, 0);
+    t.launches = calloc(n, sizeof(uint));
+    if (magic)
+        t.s->vq->ext_magic = AMD_VQUEUE_EXT_MAGIC ^ 1U;
+    else
+        t.s->ext->size = offsetof(AmdVQueueExt, ready_list);
+
+    for (uint i = 0; i < n; ++i)
+        sim_enqueue(t.s, &t.s->host_parent, i, CLK_ENQUEUE_FLAGS_NO_WAIT, i);
+    while (!sim_idle(t.s) && t.s->pass < 1000)
+        launched(&t, sim_pass(t.s));
+
+    uint bad = check(&t, magic ? "bad ext_magic" : "short ext") + (t.s->ready->tail != 0);
+    free(t.launches);
+    sim_free(t.s);
+    return bad;
+}
+
+int
+main(void)
+{
+    uint bad = 0;
+
+    bad += stress(64, SIM_READY_LIST, 2000);
+    bad += stress(64, 0, 2000);
+    bad += stress(1024, SIM_READY_LIST, 2000);
+    bad += stress(1024, 0, 2000);
+    bad += fallback(true);
+    bad += fallback(false);
+    return bad != 0;
+}
@@ -0,0 +1,136 @@
+/*===--------------------------------------------------------------------------
+ *                   ROCm Device Libraries
+ *
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE.TXT for details.
+ *===------------------------------------------------------------------------*/
+
+// Host benchmark of reserve_slot of opencl/src/devenq/devenq.h against
+// the CAS loop it replaced, with threads as single lane waves reserving
+// and releasing slots of one mask that starts partly full.  The numbers
+// only compare the two with each other.
+//
+//   devenq_reserve_bench [threads] [iterations]
+
+#include "host_cl.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "opencl/src/devenq/devenq.h"
+
+// reserve_slot before wave aggregation: each lane claims its bit with a
+// compare and swap, starting from the word of its local id
+static inline int
+reserve_slot_cas(__global uint * restrict mask, uint n, uint mask_groups)
+{
+    n >>= 5;
+    uint j, k, v, vv, z;
+
+    k = (get_local_linear_id() * mask_groups) % n;
+
+    for (j=0;j<n;++j) {
+        __global atomic_uint *p = (__global atomic_uint *)(mask + k);
+        v = atomic_load_explicit(p, memory_order_relaxed, memory_scope_device);
+        for (;;) {
+            z = ctz(~v);
+            if (z == 32U)
+                break;
+            vv = v | (1U << z);
+            if (atomic_compare_exchange_strong_explicit(p, &v, vv, memory_order_relaxed, memory_order_relaxed, memory_scope_device))
+                break;
+        }
+        if (z < 32U)
+            break;
+        k = k == n-1 ? 0 : k+1;
+    }
+
+    k = (k << 5) + z;
+    return z < 32U ? (int)k : -1;
+}
+
+#define SLOTS 1024
+#define MASK_GROUPS 1
+
+struct bench {
+    uint mask[SLOTS / 32];
+    uint iterations;
+    int cas;
+    ulong failed;
+};
+
+struct worker {
+    struct bench *b;
+    uint id;
+};
+
+static void *
+worker(void *arg)
+{
+    struct worker *w = arg;
+    struct bench *b = w->b;
+    ulong failed = 0;
+
+    // Threads stand for the first lanes of consecutive waves
+    host_local_linear_id = (size_t)w->id * 64U;
+    for (uint i = 0; i < b->iterations; ++i) {
+        int k = b->cas ? reserve_slot_cas(b->mask, SLOTS, MASK_GROUPS)
+                       : reserve_slot(b->mask, SLOTS, MASK_GROUPS);
+        if (k < 0)
+            ++failed;
+        else
+            release_slot(b->mask, (uint)k);
+    }
+    __atomic_fetch_add(&b->failed, failed, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+static double
+run(uint threads, uint iterations, uint full, int cas)
+{
+    struct bench b = { .iterations = iterations, .cas = cas };
+    struct worker w[64];
+    pthread_t th[64];
+
+    srand(1);
+    for (uint i = 0; i < SLOTS * full / 100U; ) {
+        uint k = (uint)rand() % SLOTS;
+        if (!((b.mask[k >> 5] >> (k & 31)) & 1U)) {
+            b.mask[k >> 5] |= 1U << (k & 31);
+            ++i;
+        }
+    }
+
+    ulong t0 = host_realtime();
+    for (uint i = 0; i < threads; ++i) {
+        w[i].b = &b;
+        w[i].id = i;
+        pthread_create(&th[i], NULL, worker, &w[i]);
+    }
+    for (uint i = 0; i < threads; ++i)
+        pthread_join(th[i], NULL);
+    ulong t = host_realtime() - t0;
+
+    return (double)threads * iterations * 1e9 / (double)(t ? t : 1);
+}
+
+int
+main(int argc, char **argv)
+{
+    static const uint fulls[] = { 0, 50, 90, 99 };
+    uint threads = argc > 1 ? (uint)strtoul(argv[1], NULL, 0) : 8U;
+    uint iterations = argc > 2 ? (uint)strtoul(argv[2], NULL, 0) : 200000U;
+
+    if (threads < 1 || threads > 64)
+        threads = 8;
+    run(threads, iterations / 10U, 0, 1);
+
+    for (uint f = 0; f < sizeof(fulls) / sizeof(fulls[0]); ++f) {
+        double a = run(threads, iterations, fulls[f], 1);
+        double b = run(threads, iterations, fulls[f], 0);
+        printf("%2u threads, %4u slots %2u%% full: cas %10.0f/s, fetch_or %10.0f/s, x%.2f\n",
+               threads, SLOTS, fulls[f], a, b, b / a);
+    }
+    return 0;
+}
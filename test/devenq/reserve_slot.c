@@ -0,0 +1,151 @@
+/*===--------------------------------------------------------------------------
+ *                   ROCm Device Libraries
+ *
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE.TXT for details.
+ *===------------------------------------------------------------------------*/
+
+// Checks reserve_slot of opencl/src/devenq/devenq.h on lock step waves.
+//
+// On an empty mask the slots of one wave must be distinct and land in as
+// many scheduler work-groups, which scan mask_groups words each, as there
+// are active lanes, up to the number of work-groups.  A wave reserving
+// until a lane fails must get every slot exactly once before that, since
+// a lane only fails after finding each word full.
+
+#include "host_cl.h"
+#include "oclc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "opencl/src/devenq/devenq.h"
+
+#define MAX_SLOTS 4096
+
+struct spread {
+    uint slots;
+    uint mask_groups;
+    uint every;             // lanes l with l % every == 0 reserve
+    uint mask[MAX_SLOTS / 32];
+    int got[64];
+};
+
+static void
+spread_lane(void *arg)
+{
+    struct spread *s = arg;
+
+    host_local_linear_id = host_lane;
+    s->got[host_lane] = -2;
+    if (host_wave_if(host_lane % s->every == 0))
+        s->got[host_lane] = reserve_slot(s->mask, s->slots, s->mask_groups);
+    host_wave_endif();
+}
+
+static uint
+check_spread(uint w, uint slots, uint mask_groups, uint every)
+{
+    struct spread s = { .slots = slots, .mask_groups = mask_groups, .every = every };
+    uint groups = slots / 32U / mask_groups;
+    ulong seen_groups[MAX_SLOTS / 32 / 64 + 1] = { 0 };
+    uchar seen[MAX_SLOTS] = { 0 };
+    uint lanes = 0, distinct = 0, bad = 0;
+
+    host_wave_run(w, spread_lane, &s);
+
+    for (uint l = 0; l < w; ++l) {
+        int k = s.got[l];
+        if (k == -2)
+            continue;
+        ++lanes;
+        if (k < 0 || (uint)k >= slots || seen[k]++ || !((s.mask[k >> 5] >> (k & 31)) & 1U)) {
+            ++bad;
+            continue;
+        }
+        uint g = (uint)k / 32U / mask_groups;
+        if (!((seen_groups[g / 64] >> (g % 64)) & 1UL))
+            ++distinct;
+        seen_groups[g / 64] |= 1UL << (g % 64);
+    }
+
+    uint want = min(lanes, groups);
+    bad += distinct != want;
+    printf("wave%u, %4u slots, %u words per group, %2u lanes: %2u of %2u groups%s\n",
+           w, slots, mask_groups, lanes, distinct, want, bad ? "  FAILED" : "");
+    return bad;
+}
+
+struct fill {
+    uint slots;
+    uint mask_groups;
+    uint mask[MAX_SLOTS / 32];
+    uint taken[MAX_SLOTS];
+    uint granted;
+};
+
+static void
+fill_lane(void *arg)
+{
+    struct fill *f = arg;
+    bool failed = false;
+
+    host_local_linear_id = host_lane;
+    while (!sub_group_all(failed)) {
+        if (host_wave_if(!failed)) {
+            int k = reserve_slot(f->mask, f->slots, f->mask_groups);
+            if (k < 0) {
+                failed = true;
+            } else {
+                __atomic_fetch_add(&f->taken[k], 1U, __ATOMIC_RELAXED);
+                __atomic_fetch_add(&f->granted, 1U, __ATOMIC_RELAXED);
+            }
+        }
+        host_wave_endif();
+    }
+}
+
+// Every lane reserves until it fails, so any slot left over is one a lane
+// gave up on while it was free
+static uint
+check_fill(uint w, uint slots, uint mask_groups)
+{
+    struct fill *f = calloc(1, sizeof(*f));
+    uint bad = 0;
+
+    f->slots = slots;
+    f->mask_groups = mask_groups;
+    host_wave_run(w, fill_lane, f);
+
+    for (uint k = 0; k < slots; ++k)
+        bad += f->taken[k] != 1U;
+    bad += f->granted != slots;
+    printf("wave%u, %4u slots, %u words per group: filled with %u grants%s\n",
+           w, slots, mask_groups, f->granted, bad ? "  FAILED" : "");
+    free(f);
+    return bad;
+}
+
+int
+main(void)
+{
+    uint bad = 0;
+
+    __oclc_ISA_version = 9000;
+    __oclc_wavefrontsize64 = true;
+    bad += check_spread(64, 4096, 1, 1);
+    bad += check_spread(64, 1024, 2, 1);
+    bad += check_spread(64, 1024, 1, 3);
+    bad += check_spread(64, 256, 1, 1);
+    bad += check_fill(64, 4096, 1);
+    bad += check_fill(64, 256, 2);
+
+    __oclc_ISA_version = 10100;
+    __oclc_wavefrontsize64 = false;
+    bad += check_spread(32, 2048, 2, 1);
+    bad += check_spread(32, 512, 4, 2);
+    bad += check_fill(32, 1024, 4);
+
+    return bad != 0;
+}
@@ -0,0 +1,187 @@
+/*===--------------------------------------------------------------------------
+ *                   ROCm Device Libraries
+ *
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE.TXT for details.
+ *===------------------------------------------------------------------------*/
+
+// Runs synthetic trees of device enqueues through the scheduler of
+// opencl/src/devenq/schedule.h, once scanning aql_slot_mask and once with
+// the ready list, and reports how many passes each took and how many
+// passes a dispatch waited from enqueue to launch.
+//
+// The host enqueues the root.  Each launched kernel then enqueues its
+// children, one per work-item, the odd ones with
+// CLK_ENQUEUE_FLAGS_WAIT_KERNEL, and the run ends when the root has
+// completed.  Every node must have been launched exactly once, its wrap
+// still BUSY when it runs, and every slot handed back.  A pass has a scheduler work-group per mask_groups
+// words of the mask, so fewer work-groups launch fewer dispatches a pass.
+
+#include "sim.h"
+
+#define SLOTS 1024
+#define MAX_PASSES 100000
+
+struct dag {
+    const char *name;
+    uint n;
+    uint *first;        // children of i are first[i] .. first[i] + count[i] - 1
+    uint *count;
+};
+
+static struct dag
+dag_new(const char *name, uint n)
+{
+    struct dag d = { .name = name, .n = n };
+    d.first = calloc(n, sizeof(uint));
+    d.count = calloc(n, sizeof(uint));
+    return d;
+}
+
+// A complete tree of the given fan-out and depth
+static struct dag
+dag_tree(uint fan, uint depth)
+{
+    uint n = 0;
+    for (uint l = 0, w = 1; l <= depth; ++l, w *= fan)
+        n += w;
+
+    struct dag d = dag_new("tree", n);
+    for (uint i = 0; i * fan + 1 < n; ++i) {
+        d.first[i] = i * fan + 1;
+        d.count[i] = fan;
+    }
+    return d;
+}
+
+static struct dag
+dag_chain(uint n)
+{
+    struct dag d = dag_new("chain", n);
+    for (uint i = 0; i + 1 < n; ++i) {
+        d.first[i] = i + 1;
+        d.count[i] = 1;
+    }
+    return d;
+}
+
+// A root enqueueing n - 1 leaves at once
+static struct dag
+dag_burst(uint n)
+{
+    struct dag d = dag_new("burst", n);
+    d.first[0] = 1;
+    d.count[0] = n - 1;
+    return d;
+}
+
+struct run {
+    struct sim *s;
+    const struct dag *d;
+    uint *launches;
+    ulong latency;
+    ulong max_latency;
+    uint failed;        // failed enqueues and wraps retired early
+};
+
+struct kernel {
+    struct run *r;
+    struct sim_launch l;
+};
+
+// The body of a launched node: each work-item enqueues one child
+static void *
+kernel(void *arg)
+{
+    struct kernel *k = arg;
+    struct run *r = k->r;
+    uint node = (uint)k->l.node;
+
+    for (uint c = 0; c < r->d->count[node]; ++c) {
+        uint child = r->d->first[node] + c;
+        uint flags = child & 1U ? CLK_ENQUEUE_FLAGS_WAIT_KERNEL : CLK_ENQUEUE_FLAGS_NO_WAIT;
+        if (sim_enqueue(r->s, k->l.wrap, child, flags, c) != 0)
+            __atomic_fetch_add(&r->failed, 1U, __ATOMIC_RELAXED);
+    }
+    return NULL;
+}
+
+// Runs the kernels the last pass launched
+static void
+run_kernels(struct run *r, uint n)
+{
+    struct kernel *k = calloc(n, sizeof(*k));
+    pthread_t *th = calloc(n, sizeof(*th));
+
+    for (uint i = 0; i < n; ++i) {
+        struct sim_launch *l = &r->s->launched[i];
+        ulong lat = r->s->pass - l->wrap->queued_time;
+
+        ++r->launches[l->node];
+        r->failed += l->wrap->state != AQL_WRAP_BUSY;
+        r->latency += lat;
+        r->max_latency = max(r->max_latency, lat);
+
+        k[i].r = r;
+        k[i].l = *l;
+        pthread_create(&th[i], NULL, kernel, &k[i]);
+    }
+    for (uint i = 0; i < n; ++i)
+        pthread_join(th[i], NULL);
+
+    free(th);
+    free(k);
+}
+
+static uint
+run(const struct dag *d, uint slots, uint mask_groups, uint flags)
+{
+    struct run r = { .d = d };
+    uint bad = 0;
+
+    r.s = sim_new(slots, mask_groups, flags, 0);
+    r.launches = calloc(d->n, sizeof(uint));
+
+    if (sim_enqueue(r.s, &r.s->host_parent, 0, CLK_ENQUEUE_FLAGS_NO_WAIT, 0) != 0)
+        ++r.failed;
+    while (!sim_idle(r.s) && r.s->pass < MAX_PASSES)
+        run_kernels(&r, sim_pass(r.s));
+
+    for (uint i = 0; i < d->n; ++i)
+        bad += r.launches[i] != 1U;
+    bad += r.failed + !sim_idle(r.s);
+
+    printf("%-5s %4u dispatches, %-9s: %5lu passes, %6.2f passes mean latency, %3lu max%s\n",
+           d->name, d->n, flags & SIM_READY_LIST ? "ready" : "mask scan", r.s->pass,
+           (double)r.latency / (double)d->n, r.max_latency, bad ? "  FAILED" : "");
+
+    free(r.launches);
+    sim_free(r.s);
+    return bad;
+}
+
+int
+main(void)
+{
+    static const uint groups[] = { 1, 4 };
+    struct dag dags[3];
+    uint bad = 0;
+
+    dags[0] = dag_tree(4, 4);
+    dags[1] = dag_chain(64);
+    dags[2] = dag_burst(600);
+
+    for (uint g = 0; g < 2; ++g) {
+        printf("%u slots, %u scheduler work-groups\n", SLOTS, SLOTS / 32U / groups[g]);
+        for (uint i = 0; i < 3; ++i) {
+            bad += run(&dags[i], SLOTS, groups[g], 0);
+            bad += run(&dags[i], SLOTS, groups[g], SIM_READY_LIST);
+        }
+    }
+
+    for (uint i = 0; i < 3; ++i) {
+        free(dags[i].first);
+        free(dags[i].count);
+    }
+    return bad != 0;
+}
@@ -0,0 +1,242 @@
+/*===--------------------------------------------------------------------------
+ *                   ROCm Device Libraries
+ *
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE.TXT for details.
+ *===------------------------------------------------------------------------*/
+
+// Host model of a device queue for the device enqueue tests: the queue
+// laid out as the runtime does, the scheduler of opencl/src/devenq/schedule.h
+// behind a SchedulerParam of our own, and enqueue as __enqueue_kernel_basic
+// does it, without the kernel arguments.
+//
+// Time is counted in scheduler passes.  sim_pass runs one pass with a host
+// thread per scheduler work-group, as __amd_scheduler_rocm would, and
+// stands in for __ockl_memrealtime_u64, so queued times and profile records
+// are pass numbers.  The kernels launched by a pass have run by the next
+// one, as when the scheduler is queued behind them.
+
+#ifndef SIM_H
+#define SIM_H
+
+#include "host_cl.h"
+#include "oclc.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "opencl/src/devenq/devenq.h"
+
+#define CLK_ENQUEUE_FAILURE -101
+
+struct sim;
+
+typedef struct _SchedulerParam {
+    uint eng_clk;
+    AmdVQueueHeader *vqueue_header;
+    struct sim *sim;
+} SchedulerParam;
+
+// A dispatch launched by a pass
+struct sim_launch {
+    AmdAqlWrap *wrap;
+    ulong node;         // aql.kernel_object
+};
+
+// Queue features beyond the header
+#define SIM_READY_LIST 0x1U
+#define SIM_PROFILE_RING 0x2U
+
+struct sim {
+    AmdVQueueHeader *vq;
+    AmdAqlWrap *wraps;
+    uint *amask;
+    AmdVQueueExt *ext;
+    AmdReadyList *ready;
+    AmdProfileRing *ring;
+    AmdAqlWrap host_parent;     // the host's parent kernel, already done
+    SchedulerParam param;
+
+    uint groups;                // scheduler work-groups per pass
+    ulong pass;
+    struct sim_launch *launched;
+    uint nlaunched;
+};
+
+static ulong sim_clock;
+
+// The sim's clock, in passes
+ulong
+host_realtime(void)
+{
+    return __atomic_load_n(&sim_clock, __ATOMIC_RELAXED);
+}
+
+static inline void
+launchDispatch(__global SchedulerParam *param, ulong ctx, __global hsa_kernel_dispatch_packet_t *aql)
+{
+    struct sim *s = param->sim;
+    uint i = __atomic_fetch_add(&s->nlaunched, 1U, __ATOMIC_RELAXED);
+
+    (void)ctx;
+    s->launched[i].wrap = (AmdAqlWrap *)((char *)aql - offsetof(AmdAqlWrap, aql));
+    s->launched[i].node = aql->kernel_object;
+}
+
+static inline void
+profileRecord(__global SchedulerParam *param, uint commandId, uint kind, ulong time)
+{
+    ulong ring = VQUEUE_EXT(param->vqueue_header, profile_ring);
+    if (ring != 0UL)
+        profile_ring_put((__global AmdProfileRing *)ring, commandId, kind, time);
+}
+
+#include "opencl/src/devenq/schedule.h"
+
+// A queue of slots AQL slots, slots a multiple of 32 * mask_groups, with
+// the features in flags and a profile ring of ring_size records
+static inline struct sim *
+sim_new(uint slots, uint mask_groups, uint flags, uint ring_size)
+{
+    struct sim *s = calloc(1, sizeof(*s));
+    size_t hsize = sizeof(AmdVQueueHeader) + slots * sizeof(AmdAqlWrap);
+    size_t xoff = (hsize + 63) & ~(size_t)63;
+
+    s->vq = aligned_alloc(64, xoff + sizeof(AmdVQueueExt) + 64);
+    memset(s->vq, 0, xoff + sizeof(AmdVQueueExt));
+    s->wraps = (AmdAqlWrap *)(s->vq + 1);
+    s->amask = calloc(slots / 32, sizeof(uint));
+    s->ext = (AmdVQueueExt *)((char *)s->vq + xoff);
+
+    s->vq->aql_slot_num = slots;
+    s->vq->aql_slot_mask = (ulong)s->amask;
+    s->vq->mask_groups = mask_groups;
+    s->vq->event_slot_num = 32;
+    s->vq->event_slot_mask = (ulong)calloc(1, sizeof(uint));
+    s->vq->event_slots = (ulong)calloc(32, sizeof(AmdEvent));
+
+    if (flags) {
+        s->vq->ext_magic = AMD_VQUEUE_EXT_MAGIC;
+        s->vq->ext_offset = (uint)xoff;
+        s->ext->size = sizeof(AmdVQueueExt);
+    }
+    if (flags & SIM_READY_LIST) {
+        uint n = 1;
+        while (n < slots)
+            n <<= 1;
+        s->ready = calloc(1, sizeof(AmdReadyList) + n * sizeof(uint));
+        s->ready->size = n;
+        s->ext->ready_list = (ulong)s->ready;
+    }
+    if (flags & SIM_PROFILE_RING) {
+        s->ring = calloc(1, sizeof(AmdProfileRing) + ring_size * sizeof(AmdProfileRecord));
+        s->ring->size = ring_size;
+        s->ext->profile_ring = (ulong)s->ring;
+    }
+
+    s->groups = slots / 32U / mask_groups;
+    s->launched = calloc(slots, sizeof(struct sim_launch));
+    s->param.eng_clk = 1000;
+    s->param.vqueue_header = s->vq;
+    s->param.sim = s;
+    s->host_parent.state = AQL_WRAP_DONE;
+    sim_clock = 0;
+    return s;
+}
+
+static inline void
+sim_free(struct sim *s)
+{
+    free((void *)s->vq->event_slot_mask);
+    free((void *)s->vq->event_slots);
+    free(s->launched);
+    free(s->ready);
+    free(s->ring);
+    free(s->amask);
+    free(s->vq);
+    free(s);
+}
+
+// __enqueue_kernel_basic of a kernel standing for node, a child of the
+// wrap me, made by the work-item with local id lid
+static inline int
+sim_enqueue(struct sim *s, AmdAqlWrap *me, ulong node, uint flags, uint lid)
+{
+    __global AmdVQueueHeader *vq = s->vq;
+
+    host_local_linear_id = lid;
+    __global uint *amask = (__global uint *)vq->aql_slot_mask;
+    int ai = reserve_slot(amask, vq->aql_slot_num, vq->mask_groups);
+    if (ai < 0)
+        return CLK_ENQUEUE_FAILURE;
+
+    __global AmdAqlWrap *aw = (__global AmdAqlWrap *)(vq + 1) + ai;
+
+    aw->enqueue_flags = flags;
+    aw->command_id = atomic_fetch_add_explicit((__global atomic_uint *)&vq->command_counter, (uint)1, memory_order_relaxed, memory_scope_device);
+    aw->completion = 0UL;
+    aw->parent_wrap = (ulong)me;
+    aw->wait_num = 0;
+    aw->wait_done = 0;
+    aw->queued_time = __ockl_memrealtime_u64();
+    aw->aql.kernel_object = node;
+
+    atomic_fetch_add_explicit((__global atomic_uint *)&me->child_counter, (uint)1, memory_order_relaxed, memory_scope_device);
+    atomic_store_explicit((__global atomic_uint *)&aw->state, AQL_WRAP_READY, memory_order_release, memory_scope_device);
+    notify_scheduler(vq, (uint)ai);
+    return 0;
+}
+
+struct sim_group {
+    struct sim *s;
+    uint id;
+};
+
+static void *
+sim_group(void *arg)
+{
+    struct sim_group *g = arg;
+
+    host_group_id = g->id;
+    host_global_size = g->s->groups;
+    schedule_pass(&g->s->param, 0UL, g->s->vq);
+    return NULL;
+}
+
+// One scheduler pass.  Returns the number of dispatches it launched,
+// left in s->launched.
+static inline uint
+sim_pass(struct sim *s)
+{
+    struct sim_group *g = calloc(s->groups, sizeof(*g));
+    pthread_t *th = calloc(s->groups, sizeof(*th));
+
+    __atomic_store_n(&sim_clock, ++s->pass, __ATOMIC_RELAXED);
+    s->nlaunched = 0;
+    for (uint i = 0; i < s->groups; ++i) {
+        g[i].s = s;
+        g[i].id = i;
+        pthread_create(&th[i], NULL, sim_group, &g[i]);
+    }
+    for (uint i = 0; i < s->groups; ++i)
+        pthread_join(th[i], NULL);
+
+    free(th);
+    free(g);
+    return s->nlaunched;
+}
+
+// Whether every slot has been retired and handed back
+static inline bool
+sim_idle(struct sim *s)
+{
+    for (uint i = 0; i < s->vq->aql_slot_num / 32U; ++i)
+        if (s->amask[i])
+            return false;
+    return s->host_parent.child_counter == 0 &&
+           (!s->ready || s->ready->head == s->ready->tail);
+}
+
+#endif // SIM_H
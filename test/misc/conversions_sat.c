@@ -0,0 +1,180 @@
+/*===--------------------------------------------------------------------------
+ *                   ROCm Device Libraries
+ *
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE.TXT for details.
+ *===------------------------------------------------------------------------*/
+
+// Exhaustive check that the med3 clamp of the saturating conversions in
+// opencl/src/misc/conversions.cl (CLAMPFN) gives the same result as the
+// min(max()) clamp it replaced, for every float and every half input.
+//
+// The old clamp is min(max(F(x), lb), ub) with the library's NaN-ignoring
+// min and max.  The new one is v_med3_f32 / v_med3_f16 on F(x), lb and ub,
+// modelled here after the ISA description, including its NaN rule.  F is
+// rint, floor, ceil or nothing for _rte, _rtn, _rtp and _rtz.
+//
+// Both clamps only see F(x), which is itself a float (half), so checking
+// every float (half) as F(x) covers all four rounding modes at once.
+
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// The TO_float_lb and TO_float_ub bounds, and TO_half_*, of conversions.cl
+static const struct { const char *name; float lb, ub; int half; } targets[] = {
+    { "char", -128.0f, 127.0f, 1 },
+    { "uchar", 0.0f, 255.0f, 1 },
+    { "short", -32768.0f, 32767.0f, 0 },
+    { "ushort", 0.0f, 65535.0f, 0 },
+};
+
+#define NTARGETS (int)(sizeof(targets) / sizeof(targets[0]))
+
+static long
+to_int(int t, float v)
+{
+    switch (t) {
+    case 0: return (signed char)v;
+    case 1: return (unsigned char)v;
+    case 2: return (short)v;
+    default: return (unsigned short)v;
+    }
+}
+
+// IEEE minNum and maxNum: a NaN operand is ignored
+static inline float
+min_num(float a, float b)
+{
+    return isnan(a) ? b : isnan(b) ? a : b < a ? b : a;
+}
+
+static inline float
+max_num(float a, float b)
+{
+    return isnan(a) ? b : isnan(b) ? a : a < b ? b : a;
+}
+
+static inline float
+old_clamp(float x, float lb, float ub)
+{
+    return min_num(max_num(x, lb), ub);
+}
+
+static inline float min3(float a, float b, float c) { return min_num(min_num(a, b), c); }
+static inline float max3(float a, float b, float c) { return max_num(max_num(a, b), c); }
+
+// V_MED3_F32 and V_MED3_F16
+static inline float
+med3(float a, float b, float c)
+{
+    if (isnan(a) || isnan(b) || isnan(c))
+        return min3(a, b, c);
+
+    float m = max3(a, b, c);
+    if (m == a)
+        return max_num(b, c);
+    if (m == b)
+        return max_num(a, c);
+    return max_num(a, b);
+}
+
+struct job {
+    uint64_t begin;
+    uint64_t end;
+    uint64_t fails;
+};
+
+static void
+report(const char *from, uint32_t bits, int t, long want, long got)
+{
+    fprintf(stderr, "convert_%s_sat_rt*(%s with F(x) = 0x%08x): min/max %ld, med3 %ld\n",
+            targets[t].name, from, bits, want, got);
+}
+
+static void *
+run_float(void *arg)
+{
+    struct job *j = arg;
+
+    for (uint64_t i = j->begin; i < j->end; ++i) {
+        uint32_t bits = (uint32_t)i;
+        float x;
+        memcpy(&x, &bits, sizeof(x));
+
+        for (int t = 0; t < NTARGETS; ++t) {
+            long want = to_int(t, old_clamp(x, targets[t].lb, targets[t].ub));
+            long got = to_int(t, med3(x, targets[t].lb, targets[t].ub));
+            if (want != got) {
+                if (j->fails++ < 8)
+                    report("float", bits, t, want, got);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+static uint64_t
+check_half(void)
+{
+    uint64_t fails = 0;
+
+    for (uint32_t bits = 0; bits < 0x10000U; ++bits) {
+        uint16_t hb = (uint16_t)bits;
+        _Float16 h;
+        memcpy(&h, &hb, sizeof(h));
+
+        // Every half and both bounds are exact in float, so are the
+        // min, max and med3 of them
+        for (int t = 0; t < NTARGETS; ++t) {
+            if (!targets[t].half)
+                continue;
+            _Float16 lb = (_Float16)targets[t].lb;
+            _Float16 ub = (_Float16)targets[t].ub;
+            long want = to_int(t, (float)(_Float16)old_clamp((float)h, (float)lb, (float)ub));
+            long got = to_int(t, (float)(_Float16)med3((float)h, (float)lb, (float)ub));
+            if (want != got) {
+                if (fails++ < 8)
+                    report("half", bits, t, want, got);
+            }
+        }
+    }
+
+    return fails;
+}
+
+int
+main(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n < 1)
+        n = 1;
+    if (n > 64)
+        n = 64;
+
+    pthread_t th[64];
+    struct job jobs[64];
+    uint64_t total = 1ULL << 32;
+
+    for (long i = 0; i < n; ++i) {
+        jobs[i].begin = total * (uint64_t)i / (uint64_t)n;
+        jobs[i].end = total * (uint64_t)(i + 1) / (uint64_t)n;
+        jobs[i].fails = 0;
+        pthread_create(&th[i], NULL, run_float, &jobs[i]);
+    }
+
+    uint64_t fails = check_half();
+    for (long i = 0; i < n; ++i) {
+        pthread_join(th[i], NULL);
+        fails += jobs[i].fails;
+    }
+
+    printf("%d targets, 2^32 float and 2^16 half inputs: %llu mismatches\n",
+           NTARGETS, (unsigned long long)fails);
+    return fails != 0;
+}
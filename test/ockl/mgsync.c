@@ -0,0 +1,92 @@
+/*===--------------------------------------------------------------------------
+ *                   ROCm Device Libraries
+ *
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE.TXT for details.
+ *===------------------------------------------------------------------------*/
+
+// Runs mg_barrier of ockl/src/mgsync.h on host threads, each standing in
+// for the leader of one grid of a multi-grid launch.  Before barrier r
+// every thread bumps a counter of its own to r+1, and after it checks
+// that every other counter has reached r+1, so a leader leaving a barrier
+// before the last one arrives is caught.
+
+#include "host_cl.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ockl/src/mgsync.h"
+
+#define MAX_GRIDS 64
+
+static struct mg_sync sync_block;
+static uint ngrids;
+static uint rounds;
+static uint arrived[MAX_GRIDS];
+static uint fails;
+
+static void *
+leader(void *arg)
+{
+    uint me = (uint)(uintptr_t)arg;
+
+    for (uint r = 0; r < rounds; ++r) {
+        __atomic_store_n(&arrived[me], r + 1U, __ATOMIC_RELAXED);
+        mg_barrier(&sync_block, ngrids);
+
+        for (uint i = 0; i < ngrids; ++i) {
+            uint a = __atomic_load_n(&arrived[i], __ATOMIC_RELAXED);
+            if (a < r + 1U && __atomic_fetch_add(&fails, 1U, __ATOMIC_RELAXED) < 8U)
+                fprintf(stderr, "round %u: grid %u left while grid %u was at %u\n",
+                        r, me, i, a);
+        }
+
+        // Nobody may run two barriers ahead of the slowest grid
+        mg_barrier(&sync_block, ngrids);
+    }
+
+    return NULL;
+}
+
+static int
+run(uint n, uint r)
+{
+    pthread_t th[MAX_GRIDS];
+
+    ngrids = n;
+    rounds = r;
+    fails = 0;
+    sync_block.w0 = 0;
+    sync_block.w1 = 0;
+    for (uint i = 0; i < n; ++i)
+        arrived[i] = 0;
+
+    for (uint i = 0; i < n; ++i)
+        pthread_create(&th[i], NULL, leader, (void *)(uintptr_t)i);
+    for (uint i = 0; i < n; ++i)
+        pthread_join(th[i], NULL);
+
+    // Two barriers per round, and the control block is left ready for reuse
+    uint gen = sync_block.w1;
+    int bad = fails != 0 || sync_block.w0 != 0 || gen != 2U * r;
+    printf("%2u grids, %u rounds: %u early departures, generation %u, count %u%s\n",
+           n, r, fails, gen, sync_block.w0, bad ? "  FAILED" : "");
+    return bad;
+}
+
+int
+main(int argc, char **argv)
+{
+    uint r = argc > 1 ? (uint)strtoul(argv[1], NULL, 0) : 2000U;
+    int bad = 0;
+
+    bad |= run(1, r);
+    bad |= run(2, r);
+    bad |= run(3, r);
+    bad |= run(8, r);
+    bad |= run(MAX_GRIDS, r / 10U);
+
+    return bad;
+}
@@ -0,0 +1,192 @@
+/*===--------------------------------------------------------------------------
+ *                   ROCm Device Libraries
+ *
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE.TXT for details.
+ *===------------------------------------------------------------------------*/
+
+// Runs ockl/src/wfsort.cl on a lock step host wave for every ISA and wave
+// size path of its lane exchange.  The emulated swizzle, DPP, permlanex16
+// and bpermute of host_cl.c follow the ISA, including which targets have
+// them and how far across the wave they reach, so a path using a lane
+// exchange its target lacks aborts the test.
+//
+// Each path checks xchg(x, j, l) against x of lane l ^ j for every j, then
+// sorts random u32 and f32 waves both ways, sorts key value pairs with
+// many ties, and takes the top n for random n.
+
+#include "host_cl.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ockl/src/wfsort.cl"
+
+#define TRIALS 16
+
+static const struct { int isa; bool w64; } paths[] = {
+    { 7000, true },   // swizzle, readlane across the halves
+    { 8000, true },   // DPP quad_perm, bpermute across the halves
+    { 9000, true },
+    { 10100, false }, // DPP row_xmask, permlanex16
+    { 10100, true },  // as wave32, readlane across the halves
+};
+
+#define NPATHS (int)(sizeof(paths) / sizeof(paths[0]))
+
+struct ctx {
+    uint w;
+    uint xchg_fails;
+    uint n[TRIALS];
+    uint in[TRIALS][64], out[TRIALS][64], top[TRIALS][64];
+    float fin[TRIALS][64], fout[TRIALS][64];
+    uint kin[TRIALS][64], kout[TRIALS][64], vout[TRIALS][64];
+};
+
+static uint
+tag(uint l)
+{
+    return l * 0x9e3779b9U + 1U;
+}
+
+static void
+lane_main(void *arg)
+{
+    struct ctx *c = arg;
+    uint l = host_lane;
+
+    for (uint j = 1; j < c->w; j <<= 1) {
+        if (xchg(tag(l), j, l) != tag(l ^ j))
+            __atomic_fetch_add(&c->xchg_fails, 1U, __ATOMIC_RELAXED);
+    }
+
+    for (uint t = 0; t < TRIALS; ++t) {
+        bool dsc = t & 1U;
+        c->out[t][l] = __ockl_wfsort_u32(c->in[t][l], dsc);
+        c->fout[t][l] = __ockl_wfsort_f32(c->fin[t][l], dsc);
+        uint2 kv = __ockl_wfsort_kv_u32(c->kin[t][l], l, dsc);
+        c->kout[t][l] = kv.x;
+        c->vout[t][l] = kv.y;
+        c->top[t][l] = __ockl_wftopk_u32(c->in[t][l], c->n[t]);
+    }
+}
+
+static int
+cmp_u32(const void *a, const void *b)
+{
+    uint x = *(const uint *)a, y = *(const uint *)b;
+    return x < y ? -1 : x > y;
+}
+
+// Ascending with -0 before +0, the order of f2key
+static int
+cmp_f32(const void *a, const void *b)
+{
+    float x = *(const float *)a, y = *(const float *)b;
+    if (x != y)
+        return x < y ? -1 : 1;
+    return (signbit(y) != 0) - (signbit(x) != 0);
+}
+
+static float
+random_float(void)
+{
+    static const float special[] = { 0.0f, -0.0f, INFINITY, -INFINITY, 1.0f, -1.0f };
+    if (rand() % 8 == 0)
+        return special[rand() % 6];
+
+    float f;
+    do {
+        uint u = ((uint)rand() << 16) ^ (uint)rand();
+        memcpy(&f, &u, sizeof(f));
+    } while (isnan(f));
+    return f;
+}
+
+static void
+reverse(void *p, uint n, size_t size)
+{
+    char *b = p, t[8];
+    for (uint i = 0; i < n / 2U; ++i) {
+        memcpy(t, b + i * size, size);
+        memcpy(b + i * size, b + (n - 1U - i) * size, size);
+        memcpy(b + (n - 1U - i) * size, t, size);
+    }
+}
+
+static uint
+check(struct ctx *c)
+{
+    uint w = c->w;
+    uint fails = 0;
+
+    for (uint t = 0; t < TRIALS; ++t) {
+        bool dsc = t & 1U;
+        uint ref[64];
+        float fref[64];
+
+        memcpy(ref, c->in[t], sizeof(ref));
+        qsort(ref, w, sizeof(uint), cmp_u32);
+        reverse(ref, w, sizeof(uint));
+        for (uint i = 0; i < c->n[t]; ++i)
+            fails += c->top[t][i] != ref[i];
+        if (!dsc)
+            reverse(ref, w, sizeof(uint));
+        fails += memcmp(ref, c->out[t], w * sizeof(uint)) != 0;
+
+        memcpy(fref, c->fin[t], sizeof(fref));
+        qsort(fref, w, sizeof(float), cmp_f32);
+        if (dsc)
+            reverse(fref, w, sizeof(float));
+        fails += memcmp(fref, c->fout[t], w * sizeof(float)) != 0;
+
+        // The values are the lanes the pairs came from, so each must show
+        // up once, still with its own key
+        ulong seen = 0;
+        for (uint i = 0; i < w; ++i) {
+            uint v = c->vout[t][i];
+            fails += v >= w || ((seen >> v) & 1UL) || c->kin[t][v] != c->kout[t][i];
+            seen |= 1UL << (v & 63U);
+            if (i > 0)
+                fails += dsc ? c->kout[t][i - 1] < c->kout[t][i] : c->kout[t][i - 1] > c->kout[t][i];
+        }
+    }
+
+    return fails;
+}
+
+int
+main(void)
+{
+    static struct ctx c;
+    int bad = 0;
+
+    srand(1);
+    for (int p = 0; p < NPATHS; ++p) {
+        __oclc_ISA_version = paths[p].isa;
+        __oclc_wavefrontsize64 = paths[p].w64;
+
+        memset(&c, 0, sizeof(c));
+        c.w = paths[p].w64 ? 64U : 32U;
+        for (uint t = 0; t < TRIALS; ++t) {
+            c.n[t] = 1U + (uint)rand() % c.w;
+            for (uint l = 0; l < c.w; ++l) {
+                c.in[t][l] = ((uint)rand() << 16) ^ (uint)rand();
+                if (t & 2U)
+                    c.in[t][l] &= 0xfU;
+                c.fin[t][l] = random_float();
+                c.kin[t][l] = (uint)rand() % 8U;
+            }
+        }
+
+        host_wave_run(c.w, lane_main, &c);
+        uint fails = check(&c);
+
+        printf("ISA %5d wave%u: %u xchg mismatches, %u bad results in %d trials\n",
+               paths[p].isa, c.w, c.xchg_fails, fails, TRIALS);
+        bad |= c.xchg_fails != 0 || fails != 0;
+    }
+
+    return bad;
+}
@@ -0,0 +1,191 @@
+/*===--------------------------------------------------------------------------
+ *                   ROCm Device Libraries
+ *
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE.TXT for details.
+ *===------------------------------------------------------------------------*/
+
+// Host benchmark of the pipe built-ins, one single lane wave per thread.
+// The numbers only compare the schemes with each other: host atomics and
+// threads are not a GPU's, nor does the host run the device's copies.
+//
+//   pipes_bench [threads] [packets]
+//
+// reserve: packets per second through a pipe in the default mode, whose
+// reserve / wave_reserve_1 scheme is only safe with the writers and the
+// readers kept apart, and in the MPMC mode, first with the same phases and
+// then with both sides running at once on a small pipe.
+//
+// copy: for each natural packet size, the time per packet of pipe_copy
+// against __memcpy_internal_aligned, which every packet went through
+// before the size specialized entry points, and the rate of a write and
+// read through the specialized __write_pipe_2_<size> / __read_pipe_2_<size>
+// against the generic __write_pipe_2 / __read_pipe_2.
+
+#include "pipe_host.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+struct bench {
+    struct pipeimp *p;
+    uint packets;       // per thread
+    uint blocking;
+    ulong moved;
+};
+
+static void *
+writer(void *arg)
+{
+    struct bench *b = arg;
+    ulong n = 0;
+
+    for (uint s = 0; s < b->packets; ++s) {
+        if (b->blocking)
+            n += __write_pipe_2_blocking_4(b->p, &s, PIPE_CAS_SLEEP_MAX) == 0;
+        else
+            n += __write_pipe_2_4(b->p, &s) == 0;
+    }
+    __atomic_fetch_add(&b->moved, n, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+static void *
+reader(void *arg)
+{
+    struct bench *b = arg;
+    ulong n = 0;
+
+    for (uint s = 0; s < b->packets; ++s) {
+        uint v;
+        if (b->blocking)
+            n += __read_pipe_2_blocking_4(b->p, &v, PIPE_CAS_SLEEP_MAX) == 0;
+        else
+            n += __read_pipe_2_4(b->p, &v) == 0;
+    }
+    __atomic_fetch_add(&b->moved, n, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+// Runs nw writers and nr readers together and returns packets per second
+static double
+run(struct bench *b, uint nw, uint nr)
+{
+    pthread_t th[128];
+
+    b->moved = 0;
+    ulong t0 = host_realtime();
+    for (uint i = 0; i < nw + nr; ++i)
+        pthread_create(&th[i], NULL, i < nw ? writer : reader, b);
+    for (uint i = 0; i < nw + nr; ++i)
+        pthread_join(th[i], NULL);
+    ulong t = host_realtime() - t0;
+
+    return (double)b->moved * 1e9 / (double)(t ? t : 1);
+}
+
+static void
+bench_reserve(uint threads, uint packets)
+{
+    for (int mpmc = 0; mpmc < 2; ++mpmc) {
+        struct bench b = { .packets = packets };
+        b.p = pipe_new((size_t)threads * packets, sizeof(uint), mpmc);
+
+        double w = run(&b, threads, 0);
+        ulong written = b.moved;
+        double r = run(&b, 0, threads);
+        printf("reserve %-7s phased    %2u writers %10.0f/s, %2u readers %10.0f/s%s\n",
+               mpmc ? "mpmc" : "default", threads, w, threads, r,
+               b.moved == written ? "" : "  (packets lost)");
+        free(b.p);
+    }
+
+    struct bench b = { .packets = packets, .blocking = 1 };
+    b.p = pipe_new(64, sizeof(uint), true);
+    double c = run(&b, threads, threads);
+    printf("reserve %-7s concurrent %u+%u threads, 64 slots   %10.0f/s\n",
+           "mpmc", threads, threads, c / 2.0);
+    free(b.p);
+}
+
+#define COPY_RING 256
+
+static uchar copy_src[COPY_RING * 128] __attribute__((aligned(128)));
+static uchar copy_dst[COPY_RING * 128] __attribute__((aligned(128)));
+
+// Nanoseconds per packet copied with pipe_copy, m == 0, or
+// __memcpy_internal_aligned, m == 1
+static double
+time_copy(uint size, uint n, int m)
+{
+    ulong t0 = host_realtime();
+    for (uint i = 0; i < n; ++i) {
+        uint o = (i % COPY_RING) * size;
+        if (m)
+            __memcpy_internal_aligned(copy_dst + o, copy_src + o, size, size);
+        else
+            pipe_copy(copy_dst + o, copy_src + o, size, size);
+        __asm__ volatile("" ::: "memory");
+    }
+    return (double)(host_realtime() - t0) / (double)n;
+}
+
+// Packets per second written then read in batches of a pipe's worth
+#define TIME_PIPE_SIZE(SIZE, STYPE) \
+static double \
+time_pipe_##SIZE(struct pipeimp *p, uint n, int generic) \
+{ \
+    STYPE v; \
+    __builtin_memset(&v, 0, sizeof(v)); \
+    ulong t0 = host_realtime(); \
+    for (uint i = 0; i < n; i += COPY_RING) { \
+        for (uint j = 0; j < COPY_RING; ++j) { \
+            if (generic) \
+                __write_pipe_2(p, &v, SIZE, SIZE); \
+            else \
+                __write_pipe_2_##SIZE(p, &v); \
+        } \
+        for (uint j = 0; j < COPY_RING; ++j) { \
+            if (generic) \
+                __read_pipe_2(p, &v, SIZE, SIZE); \
+            else \
+                __read_pipe_2_##SIZE(p, &v); \
+        } \
+    } \
+    return (double)n * 1e9 / (double)(host_realtime() - t0); \
+}
+
+DO_PIPE_SIZE(TIME_PIPE_SIZE)
+
+#define BENCH_COPY_SIZE(SIZE, STYPE) \
+    { \
+        struct pipeimp *p = pipe_new(COPY_RING, SIZE, false); \
+        double c0 = time_copy(SIZE, packets, 0); \
+        double c1 = time_copy(SIZE, packets, 1); \
+        double s = time_pipe_##SIZE(p, packets, 0); \
+        double g = time_pipe_##SIZE(p, packets, 1); \
+        printf("copy %3u bytes: pipe_copy %6.2f ns, memcpy %6.2f ns, x%5.2f; " \
+               "specialized %10.0f/s, generic %10.0f/s\n", \
+               SIZE, c0, c1, c1 / c0, s, g); \
+        free(p); \
+    }
+
+static void
+bench_copy(uint packets)
+{
+    DO_PIPE_SIZE(BENCH_COPY_SIZE)
+}
+
+int
+main(int argc, char **argv)
+{
+    uint threads = argc > 1 ? (uint)strtoul(argv[1], NULL, 0) : 4U;
+    uint packets = argc > 2 ? (uint)strtoul(argv[2], NULL, 0) : 200000U;
+
+    if (threads < 1 || threads > 64)
+        threads = 4;
+    bench_reserve(threads, packets);
+    bench_copy(packets * 10U);
+    return 0;
+}
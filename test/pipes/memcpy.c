@@ -0,0 +1,154 @@
+/*===--------------------------------------------------------------------------
+ *                   ROCm Device Libraries
+ *
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE.TXT for details.
+ *===------------------------------------------------------------------------*/
+
+// Checks the copies of opencl/src/pipes/memcpyia.cl.
+//
+// memcpy_wave is run for every lane rank of waves of several widths on
+// random sizes and source and destination alignments, and
+// __memcpy_internal_aligned on lock step waves where none, a few or many
+// lanes have a large copy, so that both the shared wave copy and the per
+// lane fallback are taken.  Every copy must match its source and leave
+// the bytes around its destination alone.
+
+#include "host_cl.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "opencl/src/pipes/memcpyia.cl"
+
+#define GUARD 64
+#define MAX_COPY 4224
+#define SPAN (GUARD + 64 + MAX_COPY + GUARD) // keeps buffers 64 aligned
+#define FILL 0xa5
+
+static uint fails;
+
+static void
+check(const uchar *buf, const uchar *d, const uchar *s, size_t n, const char *what)
+{
+    size_t o = (size_t)(d - buf);
+    int bad = memcmp(d, s, n) != 0;
+
+    for (size_t i = 0; i < SPAN && !bad; ++i)
+        bad = (i < o || i >= o + n) && buf[i] != FILL;
+
+    if (bad && __atomic_fetch_add(&fails, 1U, __ATOMIC_RELAXED) < 8U)
+        fprintf(stderr, "%s: %zu bytes to offset %zu from %p\n", what, n, o, (const void *)s);
+}
+
+static void
+random_bytes(uchar *p, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+        p[i] = (uchar)rand();
+}
+
+static void
+test_memcpy_wave(void)
+{
+    static const uint widths[] = { 1, 3, 32, 64 };
+    static uchar src[SPAN] __attribute__((aligned(64)));
+    static uchar dst[SPAN] __attribute__((aligned(64)));
+
+    for (uint t = 0; t < 2000; ++t) {
+        uint w = widths[t % 4];
+        size_t n = t < 200 ? t : (size_t)rand() % MAX_COPY;
+        uint so = GUARD + (uint)rand() % 64U;
+        uint dofs = GUARD + (uint)rand() % 64U;
+
+        random_bytes(src, SPAN);
+        memset(dst, FILL, SPAN);
+        for (uint l = 0; l < w; ++l)
+            memcpy_wave(dst + dofs, src + so, n, l, w);
+        check(dst, dst + dofs, src + so, n, "memcpy_wave");
+    }
+}
+
+#define TRIALS 24
+
+// One copy per lane and trial
+struct lane_copy {
+    uchar *buf;
+    uchar *d;
+    const uchar *s;
+    size_t n;
+    size_t align;
+};
+
+struct wave_run {
+    uint w;
+    struct lane_copy c[TRIALS][64];
+};
+
+static void
+lane_main(void *arg)
+{
+    struct wave_run *r = arg;
+
+    for (uint t = 0; t < TRIALS; ++t) {
+        struct lane_copy *c = &r->c[t][host_lane];
+        __memcpy_internal_aligned(c->d, c->s, c->n, c->align);
+        check(c->buf, c->d, c->s, c->n, "__memcpy_internal_aligned");
+    }
+}
+
+// Trial t gives a large copy to bigs[t % 6] lanes, picked at random
+static void
+test_wave(int isa, bool w64)
+{
+    static const size_t aligns[] = { 1, 2, 4, 8, 16, 32 };
+    uint w = w64 ? 64U : 32U;
+    uint bigs[] = { 0, 1, 3, WAVE_COPY_LANES, WAVE_COPY_LANES + 1, w };
+    struct wave_run *r = calloc(1, sizeof(*r));
+    uchar *mem = aligned_alloc(64, (size_t)TRIALS * w * 2 * SPAN);
+
+    __oclc_ISA_version = isa;
+    __oclc_wavefrontsize64 = w64;
+    r->w = w;
+
+    for (uint t = 0; t < TRIALS; ++t) {
+        ulong big = 0;
+        while ((uint)__builtin_popcountl(big) < bigs[t % 6])
+            big |= 1UL << (rand() % w);
+
+        for (uint l = 0; l < w; ++l) {
+            struct lane_copy *c = &r->c[t][l];
+            uchar *s = mem + ((size_t)t * w + l) * 2 * SPAN;
+            size_t a = aligns[rand() % 6];
+
+            c->buf = s + SPAN;
+            c->align = a;
+            c->n = (big >> l) & 1UL ? WAVE_COPY_MIN + (size_t)rand() % (MAX_COPY - WAVE_COPY_MIN)
+                                    : (size_t)rand() % 300;
+            c->n &= ~(a - 1);
+            c->s = s + GUARD + a * ((size_t)rand() % (64 / a));
+            c->d = c->buf + GUARD + a * ((size_t)rand() % (64 / a));
+            random_bytes(s, SPAN);
+            memset(c->buf, FILL, SPAN);
+        }
+    }
+
+    host_wave_run(w, lane_main, r);
+    printf("ISA %5d wave%u: %d trials of __memcpy_internal_aligned\n", isa, w, TRIALS);
+    free(mem);
+    free(r);
+}
+
+int
+main(void)
+{
+    srand(1);
+    test_memcpy_wave();
+    test_wave(9000, true);
+    test_wave(10100, false);
+    test_wave(10100, true);
+
+    printf("%u bad copies\n", fails);
+    return fails != 0;
+}
@@ -0,0 +1,257 @@
+/*===--------------------------------------------------------------------------
+ *                   ROCm Device Libraries
+ *
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE.TXT for details.
+ *===------------------------------------------------------------------------*/
+
+// Stress test of the MPMC pipe mode, with producers and consumers running
+// at the same time on a small pipe.  Every packet must be read exactly
+// once, intact, and the packets of one producer must reach each consumer
+// in the order they were written.
+//
+// Single lane waves, one per thread, use the blocking built-ins on a
+// natural size packet and on a 24 byte one, which goes through the
+// generic copy.  Lock step waves of 32 and 64 lanes use the non-blocking
+// ones, so the whole wave reservation path is taken.
+
+#include "pipe_host.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+struct pkt24 {
+    uint producer;
+    uint seq;
+    ulong check;
+    ulong tag;
+};
+
+static ulong
+mix(uint p, uint s)
+{
+    ulong x = ((ulong)p << 32 | s) * 0x9e3779b97f4a7c15UL;
+    return x ^ (x >> 29);
+}
+
+struct run {
+    struct pipeimp *p;
+    uint producers;
+    uint packets;       // per producer
+    uint big;           // 24 byte packets
+    ulong claimed;
+    uchar *seen;        // producers * packets
+    uint fails;
+};
+
+struct agent {
+    struct run *r;
+    uint id;
+};
+
+static void
+fail(struct run *r, const char *what, uint p, uint s)
+{
+    if (__atomic_fetch_add(&r->fails, 1U, __ATOMIC_RELAXED) < 8U)
+        fprintf(stderr, "%s: producer %u packet %u\n", what, p, s);
+}
+
+// Record a packet read by a consumer whose last packets from each
+// producer are in last
+static void
+record(struct run *r, uint *last, uint p, uint s, const struct pkt24 *k)
+{
+    if (p >= r->producers || s >= r->packets) {
+        fail(r, "garbage", p, s);
+        return;
+    }
+    if (k && (k->check != mix(p, s) || k->tag != ~k->check))
+        fail(r, "torn", p, s);
+    if (__atomic_fetch_add(&r->seen[(size_t)p * r->packets + s], 1, __ATOMIC_RELAXED) != 0)
+        fail(r, "duplicate", p, s);
+    if (last[p] != ~0U && s <= last[p])
+        fail(r, "out of order", p, s);
+    last[p] = s;
+}
+
+static void *
+producer(void *arg)
+{
+    struct agent *a = arg;
+    struct run *r = a->r;
+
+    for (uint s = 0; s < r->packets; ++s) {
+        if (r->big) {
+            struct pkt24 k = { a->id, s, mix(a->id, s), ~mix(a->id, s) };
+            __write_pipe_2_blocking(r->p, &k, sizeof(k), 8, PIPE_CAS_SLEEP_MAX);
+        } else {
+            uint v = a->id << 20 | s;
+            __write_pipe_2_blocking_4(r->p, &v, PIPE_CAS_SLEEP_MAX);
+        }
+    }
+    return NULL;
+}
+
+static void *
+consumer(void *arg)
+{
+    struct agent *a = arg;
+    struct run *r = a->r;
+    ulong total = (ulong)r->producers * r->packets;
+    uint *last = malloc(r->producers * sizeof(uint));
+
+    memset(last, 0xff, r->producers * sizeof(uint));
+    while (__atomic_fetch_add(&r->claimed, 1UL, __ATOMIC_RELAXED) < total) {
+        if (r->big) {
+            struct pkt24 k;
+            __read_pipe_2_blocking(r->p, &k, sizeof(k), 8, PIPE_CAS_SLEEP_MAX);
+            record(r, last, k.producer, k.seq, &k);
+        } else {
+            uint v;
+            __read_pipe_2_blocking_4(r->p, &v, PIPE_CAS_SLEEP_MAX);
+            record(r, last, v >> 20, v & 0xfffffU, NULL);
+        }
+    }
+    free(last);
+    return NULL;
+}
+
+static uint
+finish(struct run *r)
+{
+    ulong total = (ulong)r->producers * r->packets;
+    ulong lost = 0;
+
+    for (ulong i = 0; i < total; ++i)
+        lost += r->seen[i] == 0;
+    if (lost)
+        fprintf(stderr, "%lu packets lost\n", lost);
+    free(r->seen);
+    free(r->p);
+    return r->fails + (uint)(lost != 0);
+}
+
+static int
+run_threads(uint np, uint nc, size_t e, uint big, uint packets)
+{
+    struct run r = { .producers = np, .packets = packets, .big = big };
+    struct agent a[64];
+    pthread_t th[64];
+
+    r.p = pipe_new(e, big ? sizeof(struct pkt24) : sizeof(uint), true);
+    r.seen = calloc((size_t)np * packets, 1);
+
+    for (uint i = 0; i < np + nc; ++i) {
+        a[i].r = &r;
+        a[i].id = i < np ? i : i - np;
+        pthread_create(&th[i], NULL, i < np ? producer : consumer, &a[i]);
+    }
+    for (uint i = 0; i < np + nc; ++i)
+        pthread_join(th[i], NULL);
+
+    uint bad = finish(&r);
+    printf("lanes: %2u producers, %2u consumers, %3zu slots, %2u byte packets: %s\n",
+           np, nc, e, big ? (uint)sizeof(struct pkt24) : 4U, bad ? "FAILED" : "ok");
+    return bad != 0;
+}
+
+// Waves retry until each of their lanes has moved its packets, with only
+// the lanes still having some active
+static void
+producer_wave(void *arg)
+{
+    struct agent *a = arg;
+    struct run *r = a->r;
+    uint id = a->id * (__oclc_wavefrontsize64 ? 64U : 32U) + host_lane;
+    uint s = 0;
+
+    while (sub_group_any(s < r->packets)) {
+        if (host_wave_if(s < r->packets)) {
+            uint v = id << 20 | s;
+            if (__write_pipe_2_4(a->r->p, &v) == 0)
+                ++s;
+        }
+        host_wave_endif();
+        sched_yield();
+    }
+}
+
+static void
+consumer_wave(void *arg)
+{
+    struct agent *a = arg;
+    struct run *r = a->r;
+    uint *last = malloc(r->producers * sizeof(uint));
+    uint n = 0;
+
+    memset(last, 0xff, r->producers * sizeof(uint));
+    while (sub_group_any(n < r->packets)) {
+        if (host_wave_if(n < r->packets)) {
+            uint v;
+            if (__read_pipe_2_4(a->r->p, &v) == 0) {
+                record(r, last, v >> 20, v & 0xfffffU, NULL);
+                ++n;
+            }
+        }
+        host_wave_endif();
+        sched_yield();
+    }
+    free(last);
+}
+
+static void *
+run_wave(void *arg)
+{
+    struct agent *a = arg;
+    host_wave_run(__oclc_wavefrontsize64 ? 64U : 32U,
+                  a->id & 0x80000000U ? consumer_wave : producer_wave, a);
+    return NULL;
+}
+
+// Waves of producers and as many of consumers, each consumer lane
+// reading as many packets as a producer lane writes
+static int
+run_waves(int isa, bool w64, uint nw, size_t e, uint packets)
+{
+    uint w = w64 ? 64U : 32U;
+    struct run r = { .producers = nw * w, .packets = packets };
+    struct agent a[16];
+    pthread_t th[16];
+
+    __oclc_ISA_version = isa;
+    __oclc_wavefrontsize64 = w64;
+    r.p = pipe_new(e, sizeof(uint), true);
+    r.seen = calloc((size_t)r.producers * packets, 1);
+
+    for (uint i = 0; i < 2U * nw; ++i) {
+        a[i].r = &r;
+        a[i].id = i < nw ? i : 0x80000000U | (i - nw);
+        pthread_create(&th[i], NULL, run_wave, &a[i]);
+    }
+    for (uint i = 0; i < 2U * nw; ++i)
+        pthread_join(th[i], NULL);
+
+    uint bad = finish(&r);
+    printf("waves: %u+%u wave%u, %3zu slots: %s\n", nw, nw, w, e, bad ? "FAILED" : "ok");
+    return bad != 0;
+}
+
+int
+main(int argc, char **argv)
+{
+    uint packets = argc > 1 ? (uint)strtoul(argv[1], NULL, 0) : 20000U;
+    int bad = 0;
+
+    for (uint big = 0; big < 2; ++big) {
+        bad |= run_threads(1, 1, 1, big, packets);
+        bad |= run_threads(4, 4, 3, big, packets);
+        bad |= run_threads(8, 2, 16, big, packets);
+        bad |= run_threads(2, 8, 61, big, packets);
+    }
+
+    bad |= run_waves(10100, false, 2, 17, packets / 100U);
+    bad |= run_waves(9000, true, 2, 100, packets / 100U);
+
+    return bad;
+}
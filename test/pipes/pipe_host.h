@@ -0,0 +1,49 @@
+/*===--------------------------------------------------------------------------
+ *                   ROCm Device Libraries
+ *
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE.TXT for details.
+ *===------------------------------------------------------------------------*/
+
+// What the pipe tests need of readp.cl and writep.cl, which readp.c and
+// writep.c build for the host, and a host side pipe allocator.
+
+#ifndef PIPE_HOST_H
+#define PIPE_HOST_H
+
+#include "host_cl.h"
+
+#include <stdlib.h>
+
+#include "oclc.h"
+#include "opencl/src/pipes/pipes.h"
+
+#define PIPE_2_DECL(SIZE, STYPE) \
+extern int __read_pipe_2_##SIZE(struct pipeimp *p, STYPE *ptr); \
+extern int __write_pipe_2_##SIZE(struct pipeimp *p, const STYPE *ptr);
+
+DO_PIPE_SIZE(PIPE_2_DECL)
+
+extern int __read_pipe_2(struct pipeimp *p, void *ptr, uint size, uint align);
+extern int __write_pipe_2(struct pipeimp *p, const void *ptr, uint size, uint align);
+
+// A zeroed pipe of e packets of the given size, laid out as the runtime
+// does, with the slot sequences of an MPMC pipe after the packets
+static inline struct pipeimp *
+pipe_new(size_t e, uint size, bool mpmc)
+{
+    size_t n = offsetof(struct pipeimp, packets) +
+               ((e * size + sizeof(size_t) - 1) & ~(sizeof(size_t) - 1)) +
+               e * sizeof(size_t);
+    struct pipeimp *p = aligned_alloc(128, (n + 127) & ~(size_t)127);
+
+    __builtin_memset(p, 0, n);
+    p->end_idx = e;
+    if (mpmc) {
+        p->magic = PIPE_MAGIC;
+        p->flags = PIPE_FLAG_MPMC;
+    }
+    return p;
+}
+
+#endif // PIPE_HOST_H
@@ -0,0 +1,15 @@
+/*===--------------------------------------------------------------------------
+ *                   ROCm Device Libraries
+ *
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE.TXT for details.
+ *===------------------------------------------------------------------------*/
+
+#ifndef DEVICE_AMD_HSA_H
+#define DEVICE_AMD_HSA_H
+
+// The HSA types as the host sees them, without the fixed width typedefs
+// of the device header, which the C library already has
+#include "ockl/inc/hsa.h"
+
+#endif // DEVICE_AMD_HSA_H
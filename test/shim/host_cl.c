@@ -0,0 +1,261 @@
+/*===--------------------------------------------------------------------------
+ *                   ROCm Device Libraries
+ *
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE.TXT for details.
+ *===------------------------------------------------------------------------*/
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "host_cl.h"
+#include "irif.h"
+#include "oclc.h"
+
+int __oclc_ISA_version = 9000;
+bool __oclc_wavefrontsize64 = true;
+
+__thread ulong host_exec = 1UL;
+__thread uint host_lane;
+__thread size_t host_local_linear_id;
+__thread size_t host_group_id;
+__thread size_t host_global_size = 1;
+__thread void *host_implicitarg;
+__thread struct host_wave *host_wave;
+
+#define HOST_WAVE_DEPTH 8
+
+// A barrier of the lanes active at one nesting depth
+struct host_wave_bar {
+    uint count;
+    uint gen;
+};
+
+struct host_wave {
+    uint size;
+    pthread_mutex_t mu;
+    pthread_cond_t cv;
+    struct host_wave_bar bar[HOST_WAVE_DEPTH];
+    ulong slot[64];
+    void (*fn)(void *);
+    void *arg;
+};
+
+struct host_wave_lane {
+    struct host_wave *w;
+    uint lane;
+};
+
+static __thread uint host_depth;
+static __thread ulong host_saved_exec[HOST_WAVE_DEPTH];
+
+static void
+host_illegal(const char *what)
+{
+    fprintf(stderr, "%s is not available on ISA version %d wave%d\n",
+            what, __oclc_ISA_version, __oclc_wavefrontsize64 ? 64 : 32);
+    abort();
+}
+
+// Wait for the lanes of host_exec, which are all at the current depth
+static void
+host_wave_sync(struct host_wave *w)
+{
+    struct host_wave_bar *b = &w->bar[host_depth];
+    uint n = (uint)__builtin_popcountl(host_exec);
+
+    pthread_mutex_lock(&w->mu);
+    uint g = b->gen;
+    if (++b->count == n) {
+        b->count = 0;
+        b->gen = g + 1U;
+        pthread_cond_broadcast(&w->cv);
+    } else {
+        while (b->gen == g)
+            pthread_cond_wait(&w->cv, &w->mu);
+    }
+    pthread_mutex_unlock(&w->mu);
+}
+
+static void *
+host_wave_lane(void *arg)
+{
+    struct host_wave_lane *l = arg;
+
+    host_wave = l->w;
+    host_lane = l->lane;
+    host_exec = l->w->size == 64 ? ~0UL : (1UL << l->w->size) - 1UL;
+    host_depth = 0;
+    l->w->fn(l->w->arg);
+    host_wave = NULL;
+    return NULL;
+}
+
+void
+host_wave_run(uint size, void (*fn)(void *), void *arg)
+{
+    struct host_wave w = { .size = size, .fn = fn, .arg = arg };
+    struct host_wave_lane l[64];
+    pthread_t th[64];
+
+    if (size != (__oclc_wavefrontsize64 ? 64U : 32U))
+        host_illegal("this wave size");
+
+    pthread_mutex_init(&w.mu, NULL);
+    pthread_cond_init(&w.cv, NULL);
+    for (uint i = 0; i < size; ++i) {
+        l[i].w = &w;
+        l[i].lane = i;
+        pthread_create(&th[i], NULL, host_wave_lane, &l[i]);
+    }
+    for (uint i = 0; i < size; ++i)
+        pthread_join(th[i], NULL);
+    pthread_cond_destroy(&w.cv);
+    pthread_mutex_destroy(&w.mu);
+}
+
+bool
+host_wave_if(bool c)
+{
+    struct host_wave *w = host_wave;
+    if (!w)
+        return c;
+
+    ulong m = host_wave_ballot(c);
+    if (host_depth + 1U == HOST_WAVE_DEPTH)
+        host_illegal("this much divergence");
+    host_saved_exec[host_depth++] = host_exec;
+    if (c)
+        host_exec = m;
+    return c;
+}
+
+void
+host_wave_endif(void)
+{
+    struct host_wave *w = host_wave;
+    if (!w)
+        return;
+
+    host_exec = host_saved_exec[--host_depth];
+    host_wave_sync(w);
+}
+
+void
+host_wave_barrier(void)
+{
+    if (host_wave)
+        host_wave_sync(host_wave);
+}
+
+// Value of v in the given lane, which reads as 0 when it is inactive
+ulong
+host_wave_read(ulong v, uint lane)
+{
+    struct host_wave *w = host_wave;
+    if (!w)
+        return v;
+
+    w->slot[host_lane] = v;
+    host_wave_sync(w);
+    ulong r = (host_exec >> lane) & 1UL ? w->slot[lane] : 0UL;
+    host_wave_sync(w);
+    return r;
+}
+
+ulong
+host_wave_ballot(bool b)
+{
+    struct host_wave *w = host_wave;
+    if (!w)
+        return (ulong)b << host_lane;
+
+    w->slot[host_lane] = b;
+    host_wave_sync(w);
+    ulong r = 0;
+    for (uint i = 0; i < w->size; ++i)
+        r |= (w->slot[i] & ((host_exec >> i) & 1UL)) << i;
+    host_wave_sync(w);
+    return r;
+}
+
+// ds_bpermute only reaches the lanes of its own 32 lane half when a gfx10
+// wave64 is run as two wave32 halves
+uint
+host_bpermute_lane(int addr)
+{
+    if (__oclc_ISA_version < 8000)
+        host_illegal("ds_bpermute");
+    uint a = ((uint)addr >> 2) & 63U;
+    if (__oclc_ISA_version >= 10000 && __oclc_wavefrontsize64)
+        return (host_lane & 32U) | (a & 31U);
+    return host_wave ? a & (host_wave->size - 1U) : a;
+}
+
+// Bit mask mode only, within groups of 32 lanes
+uint
+host_ds_swizzle(uint x, uint pattern)
+{
+    if (pattern & 0x8000U)
+        host_illegal("ds_swizzle QDMode");
+    uint andm = pattern & 0x1fU;
+    uint orm = (pattern >> 5) & 0x1fU;
+    uint xorm = (pattern >> 10) & 0x1fU;
+    uint l = host_lane & 31U;
+    return (uint)host_wave_read(x, (host_lane & ~31U) | (((l & andm) | orm) ^ xorm));
+}
+
+// quad_perm and row_xmask, with every row and bank enabled
+uint
+__llvm_amdgcn_update_dpp_i32(uint old, uint src, uint ctrl, uint row_mask, uint bank_mask, bool bound_ctrl)
+{
+    uint l = host_lane;
+    uint s;
+
+    (void)old;
+    (void)bound_ctrl;
+    if (__oclc_ISA_version < 8000)
+        host_illegal("DPP");
+    if (row_mask != 0xfU || bank_mask != 0xfU)
+        host_illegal("DPP with a row or bank mask");
+
+    if (ctrl <= 0xffU) {
+        s = (l & ~3U) | ((ctrl >> ((l & 3U) * 2U)) & 3U);
+    } else if ((ctrl & ~0xfU) == 0x160U) {
+        if (__oclc_ISA_version < 10000)
+            host_illegal("DPP row_xmask");
+        s = (l & ~15U) | ((l & 15U) ^ (ctrl & 15U));
+    } else {
+        host_illegal("this DPP control");
+        s = l;
+    }
+
+    return (uint)host_wave_read(src, s);
+}
+
+// Lane i of a row reads lane sel[i] of the other row of its 32 lane half
+uint
+__llvm_amdgcn_permlanex16(uint old, uint src, uint s0, uint s1, bool fi, bool bound_ctrl)
+{
+    uint l = host_lane;
+    uint i = l & 15U;
+
+    (void)old;
+    (void)fi;
+    (void)bound_ctrl;
+    if (__oclc_ISA_version < 10000)
+        host_illegal("v_permlanex16");
+
+    uint sel = ((i < 8U ? s0 : s1) >> ((i & 7U) * 4U)) & 15U;
+    return (uint)host_wave_read(src, (l & ~31U) | ((l & 16U) ^ 16U) | sel);
+}
+
+__attribute__((weak)) ulong
+host_realtime(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (ulong)t.tv_sec * 1000000000UL + (ulong)t.tv_nsec;
+}
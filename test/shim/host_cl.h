@@ -0,0 +1,219 @@
+/*===--------------------------------------------------------------------------
+ *                   ROCm Device Libraries
+ *
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE.TXT for details.
+ *===------------------------------------------------------------------------*/
+
+// Just enough of OpenCL C and the AMDGPU builtins for the host tests to
+// compile device sources with a host C compiler.  A host thread is one
+// work-item, running alone in its wave unless a test either sets host_exec
+// and host_lane to play the lanes of a wave one after another, or runs a
+// whole wave in lock step with host_wave_run.  Address spaces vanish,
+// atomics map onto the GCC __atomic builtins, and memory scopes are
+// ignored, the host being coherent.
+
+#ifndef HOST_CL_H
+#define HOST_CL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <limits.h>
+#include <math.h>
+#include <sched.h>
+
+#define __global
+#define __constant
+#define __local
+#define __private
+#define __kernel
+
+typedef unsigned char uchar;
+typedef unsigned short ushort;
+typedef unsigned int uint;
+typedef unsigned long ulong;
+
+// Vectors are only ever copied by the code under test
+#define HOST_VEC(T,N) \
+    typedef struct { T s[N]; } __attribute__((aligned(sizeof(T) * (N == 3 ? 4 : N)))) T##N;
+
+HOST_VEC(uint,4)
+HOST_VEC(long,2)
+HOST_VEC(long,4)
+HOST_VEC(ulong,2)
+HOST_VEC(ulong,4)
+HOST_VEC(ulong,8)
+HOST_VEC(ulong,16)
+
+typedef struct { uint x, y; } __attribute__((aligned(8))) uint2;
+
+static inline uint2
+as_uint2(ulong v)
+{
+    uint2 r;
+    __builtin_memcpy(&r, &v, sizeof(r));
+    return r;
+}
+
+typedef struct host_reserve_id *reserve_id_t;
+
+#define __builtin_astype(X,T) ({ \
+    __typeof__(X) _x = (X); \
+    T _t; \
+    _Static_assert(sizeof(_x) == sizeof(_t), "astype size"); \
+    __builtin_memcpy(&_t, &_x, sizeof(_t)); \
+    _t; \
+})
+
+// OpenCL vector literals, e.g. (uint2)(x, y), are not C.  CMake's
+// host_cl_source() rewrites them in a copy of the device source to these.
+static inline uint2
+host_make_uint2(uint x, uint y)
+{
+    uint2 r = { x, y };
+    return r;
+}
+
+// Atomics
+typedef uint atomic_uint;
+typedef int atomic_int;
+typedef ulong atomic_ulong;
+typedef long atomic_long;
+typedef size_t atomic_size_t;
+
+#define memory_order_relaxed __ATOMIC_RELAXED
+#define memory_order_acquire __ATOMIC_ACQUIRE
+#define memory_order_release __ATOMIC_RELEASE
+#define memory_order_acq_rel __ATOMIC_ACQ_REL
+#define memory_order_seq_cst __ATOMIC_SEQ_CST
+
+#define memory_scope_work_item 0
+#define memory_scope_work_group 1
+#define memory_scope_device 2
+#define memory_scope_all_svm_devices 3
+#define memory_scope_sub_group 4
+
+#define atomic_load_explicit(P,O,S) __atomic_load_n(P, O)
+#define atomic_store_explicit(P,V,O,S) __atomic_store_n(P, V, O)
+#define atomic_exchange_explicit(P,V,O,S) __atomic_exchange_n(P, V, O)
+#define atomic_fetch_add_explicit(P,V,O,S) __atomic_fetch_add(P, V, O)
+#define atomic_fetch_sub_explicit(P,V,O,S) __atomic_fetch_sub(P, V, O)
+#define atomic_fetch_or_explicit(P,V,O,S) __atomic_fetch_or(P, V, O)
+#define atomic_fetch_and_explicit(P,V,O,S) __atomic_fetch_and(P, V, O)
+#define atomic_compare_exchange_strong_explicit(P,E,D,OS,OF,S) \
+    __atomic_compare_exchange_n(P, E, D, false, OS, OF)
+#define atomic_work_item_fence(F,O,S) __atomic_thread_fence(O)
+
+#define __opencl_atomic_load(P,O,S) __atomic_load_n(P, O)
+#define __opencl_atomic_store(P,V,O,S) __atomic_store_n(P, V, O)
+#define __opencl_atomic_exchange(P,V,O,S) __atomic_exchange_n(P, V, O)
+#define __opencl_atomic_fetch_add(P,V,O,S) __atomic_fetch_add(P, V, O)
+#define __opencl_atomic_fetch_sub(P,V,O,S) __atomic_fetch_sub(P, V, O)
+#define __opencl_atomic_fetch_or(P,V,O,S) __atomic_fetch_or(P, V, O)
+#define __opencl_atomic_compare_exchange_strong(P,E,D,OS,OF,S) \
+    __atomic_compare_exchange_n(P, E, D, false, OS, OF)
+
+#define CLK_LOCAL_MEM_FENCE 1
+#define CLK_GLOBAL_MEM_FENCE 2
+
+// Device enqueue
+#define CL_COMPLETE 0
+#define CL_RUNNING 1
+#define CL_SUBMITTED 2
+#define CL_QUEUED 3
+
+#define CLK_ENQUEUE_FLAGS_NO_WAIT 0
+#define CLK_ENQUEUE_FLAGS_WAIT_KERNEL 1
+#define CLK_ENQUEUE_FLAGS_WAIT_WORK_GROUP 2
+
+// Integer and common built-ins
+#define min(A,B) ({ __typeof__(A) _a = (A); __typeof__(B) _b = (B); _b < _a ? _b : _a; })
+#define max(A,B) ({ __typeof__(A) _a = (A); __typeof__(B) _b = (B); _a < _b ? _b : _a; })
+
+static inline uint ctz(uint x) { return x ? (uint)__builtin_ctz(x) : 32U; }
+static inline uint popcount(uint x) { return (uint)__builtin_popcount(x); }
+static inline uint amd_bfm(uint w, uint o) { return ((1U << (w & 31U)) - 1U) << (o & 31U); }
+
+#define __llvm_cttz_i64(X) ((ulong)__builtin_ctzl(X))
+
+// Work-item state of the calling host thread
+extern __thread ulong host_exec;
+extern __thread uint host_lane;
+extern __thread size_t host_local_linear_id;
+extern __thread size_t host_group_id;
+extern __thread size_t host_global_size;
+extern __thread void *host_implicitarg;
+
+#define get_local_linear_id() host_local_linear_id
+#define __ockl_get_local_linear_id() host_local_linear_id
+#define get_group_id(D) host_group_id
+#define get_global_size(D) host_global_size
+
+// A wave of host threads, one per lane, run by host_wave_run.  The cross
+// lane built-ins exchange values through it between two barriers of the
+// lanes in host_exec, so each of those lanes must reach each of them.
+// Device code can't say where it diverges, so the code run on the wave
+// must be uniform around them, except where the test itself branches with
+//
+//     if (host_wave_if(c)) { ... }
+//     host_wave_endif();
+//
+// which runs the body with host_exec narrowed to the lanes where c holds.
+// The lanes of a real wave run in step, which a wave barrier stands for
+// here.  Outside of host_wave_run a cross lane read returns the caller's
+// own value, a ballot only has the caller's bit and barriers do nothing.
+struct host_wave;
+extern __thread struct host_wave *host_wave;
+
+extern void host_wave_run(uint size, void (*fn)(void *), void *arg);
+extern bool host_wave_if(bool c);
+extern void host_wave_endif(void);
+extern void host_wave_barrier(void);
+extern ulong host_wave_read(ulong v, uint lane);
+extern ulong host_wave_ballot(bool b);
+extern uint host_bpermute_lane(int addr);
+extern uint host_ds_swizzle(uint x, uint pattern);
+
+// Wave built-ins
+#define __builtin_amdgcn_read_exec() host_exec
+#define __builtin_amdgcn_read_exec_lo() ((uint)host_exec)
+#define __builtin_amdgcn_read_exec_hi() ((uint)(host_exec >> 32))
+#define __builtin_amdgcn_mbcnt_lo(M,A) host_mbcnt((uint)(M), (uint)(A), 0U)
+#define __builtin_amdgcn_mbcnt_hi(M,A) host_mbcnt((uint)(M), (uint)(A), 32U)
+
+// Count of the bits of m, the half of the mask starting at lane base,
+// which are below the calling lane
+static inline uint
+host_mbcnt(uint m, uint a, uint base)
+{
+    uint n = host_lane < base ? 0U : min(host_lane - base, 32U);
+    ulong below = (1UL << n) - 1UL;
+    return a + (uint)__builtin_popcount(m & (uint)below);
+}
+
+#define __builtin_amdgcn_readfirstlane(X) \
+    ((__typeof__(X))host_wave_read((ulong)(X), (uint)__builtin_ctzl(host_exec)))
+#define __builtin_amdgcn_readlane(X,I) ((__typeof__(X))host_wave_read((ulong)(X), (uint)(I)))
+#define __builtin_amdgcn_ds_bpermute(A,X) ((int)host_wave_read((uint)(X), host_bpermute_lane(A)))
+#define __builtin_amdgcn_ds_swizzle(X,P) host_ds_swizzle((uint)(X), (uint)(P))
+#define __builtin_amdgcn_wave_barrier() host_wave_barrier()
+#define __builtin_amdgcn_s_barrier() ((void)0)
+#define __builtin_amdgcn_s_sleep(N) sched_yield()
+#define __builtin_amdgcn_implicitarg_ptr() ((__constant void *)host_implicitarg)
+
+#define __llvm_amdgcn_icmp_i64_i32(A,B,P) host_wave_ballot((A) != (B))
+#define __llvm_amdgcn_icmp_i32_i32(A,B,P) ((uint)host_wave_ballot((A) != (B)))
+
+#define sub_group_any(B) ((int)(host_wave_ballot(B) != 0UL))
+#define sub_group_all(B) ((int)(host_wave_ballot(!(B)) == 0UL))
+
+#define __ockl_is_private_addr(P) false
+#define __ockl_is_local_addr(P) false
+
+// Clock in nanoseconds, CLOCK_MONOTONIC unless the test provides its own
+extern ulong host_realtime(void);
+#define __ockl_memrealtime_u64() host_realtime()
+#define __builtin_readcyclecounter() host_realtime()
+
+#endif // HOST_CL_H
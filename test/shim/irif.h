@@ -0,0 +1,16 @@
+/*===--------------------------------------------------------------------------
+ *                   ROCm Device Libraries
+ *
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE.TXT for details.
+ *===------------------------------------------------------------------------*/
+
+#ifndef IRIF_H
+#define IRIF_H
+
+// The intrinsics the host tests emulate, see host_cl.c
+
+extern uint __llvm_amdgcn_update_dpp_i32(uint, uint, uint, uint, uint, bool);
+extern uint __llvm_amdgcn_permlanex16(uint, uint, uint, uint, bool, bool);
+
+#endif // IRIF_H
@@ -0,0 +1,22 @@
+/*===--------------------------------------------------------------------------
+ *                   ROCm Device Libraries
+ *
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE.TXT for details.
+ *===------------------------------------------------------------------------*/
+
+#ifndef OCKL_H
+#define OCKL_H
+
+#define _MANGLE3(P,N,S) P##_##N##_##S
+#define MANGLE3(P,N,S) _MANGLE3(P,N,S)
+#define OCKL_MANGLE_T(N,T) MANGLE3(__ockl, N, T)
+#define OCKL_MANGLE_I32(N) OCKL_MANGLE_T(N, i32)
+#define OCKL_MANGLE_U32(N) OCKL_MANGLE_T(N, u32)
+#define OCKL_MANGLE_F32(N) OCKL_MANGLE_T(N, f32)
+#define OCKL_MANGLE_I64(N) OCKL_MANGLE_T(N, i64)
+#define OCKL_MANGLE_U64(N) OCKL_MANGLE_T(N, u64)
+
+#define __ockl_lane_u32() host_lane
+
+#endif // OCKL_H
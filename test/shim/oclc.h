@@ -0,0 +1,16 @@
+/*===--------------------------------------------------------------------------
+ *                   ROCm Device Libraries
+ *
+ * This file is distributed under the University of Illinois Open Source
+ * License. See LICENSE.TXT for details.
+ *===------------------------------------------------------------------------*/
+
+#ifndef OCLC_H
+#define OCLC_H
+
+// Writable on the host, so a test can run every target's path in turn.
+// They default to gfx900 wave64.
+extern int __oclc_ISA_version;
+extern bool __oclc_wavefrontsize64;
+
+#endif // OCLC_H